@@ -0,0 +1,58 @@
+/*! \file
+ *  \brief Defines the layout of binary log files.
+ *
+ *  A binary log starts with the 8 byte \ref fmtlog::binary::Magic, followed by records.
+ *  Every record starts with a RecordKind byte. All integers use the byte order of the
+ *  machine that wrote the log.
+ *
+ *  - RecordKind::Scope: \c uint32 id, \c uint32 length, name bytes
+ *  - RecordKind::Format: \c uint32 id, \c uint32 length, format string bytes
+ *  - RecordKind::Message: \c uint64 nanoseconds since program start, \c uint8 severity,
+ *    \c uint32 scope id, \c uint32 format id, \c uint8 argument count, and per argument
+ *    an ArgType byte followed by the value (strings as \c uint32 length and bytes).
+ *
+ *  Scopes and formats are defined before the first message referring to them.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace fmtlog {
+/// Definitions shared by the binary log writer and decoder.
+namespace binary {
+
+/// Identifies binary log files.
+constexpr char Magic[] = "FMTLOGB1";
+/// The size of \ref Magic in the file.
+constexpr size_t MagicSize = 8;
+
+/// The kinds of records in a binary log.
+enum class RecordKind : uint8_t {
+  Scope = 'S',
+  Format = 'F',
+  Message = 'M',
+};
+
+/// The types of message arguments.
+enum class ArgType : uint8_t {
+  Int = 0,
+  UInt = 1,
+  Double = 2,
+  String = 3,
+};
+
+/// Appends the bytes of a trivially copyable value.
+template<typename T>
+inline void append(std::string& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// Appends a string prefixed with its length.
+inline void appendString(std::string& out, const char* str, size_t length) {
+  append(out, static_cast<uint32_t>(length));
+  out.append(str, length);
+}
+}
+}
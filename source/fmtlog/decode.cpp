@@ -0,0 +1,160 @@
+/*! \file
+ *  \brief Converts binary logs written by fmtlog::enableBinary into text.
+ *
+ *  Usage: \c fmtlog-decode \c LOGFILE, the text is written to \c stdout in the same format
+ *  as the text output of fmtlog.
+ */
+#include "binaryformat.hpp"
+
+#include <boost/format.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace fmtlog;
+
+namespace {
+
+/// Reads values from a binary log, throwing on truncated input.
+class Reader {
+public:
+  explicit Reader(std::istream& in) : m_in(in) {}
+
+  /// Reads a trivially copyable value.
+  template<typename T>
+  T read() {
+    T value;
+    if (!m_in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+      throw std::runtime_error("unexpected end of log");
+    }
+    return value;
+  }
+
+  /// Reads a string prefixed with its length.
+  std::string readString() {
+    auto length = read<uint32_t>();
+    std::string str(length, '\0');
+    if (length > 0 && !m_in.read(&str[0], length)) {
+      throw std::runtime_error("unexpected end of log");
+    }
+    return str;
+  }
+
+  /// Checks whether the end of the log has been reached.
+  bool atEnd() {
+    return m_in.peek() == std::char_traits<char>::eof();
+  }
+
+private:
+  std::istream& m_in;
+};
+
+const char* severityToString(uint8_t sev) {
+  static const char* names[] = {"DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
+  return sev < 5 ? names[sev] : "UNKOWN";
+}
+
+/// Stores a definition at its ID, growing the table as necessary.
+void define(std::vector<std::string>& table, uint32_t id, std::string value) {
+  if (id >= table.size()) {
+    table.resize(id + 1);
+  }
+  table[id] = std::move(value);
+}
+
+/// Looks up a definition, failing if it has not been defined yet.
+const std::string& lookup(const std::vector<std::string>& table, uint32_t id, const char* what) {
+  if (id >= table.size()) {
+    throw std::runtime_error((boost::format("undefined %s %d") % what % id).str());
+  }
+  return table[id];
+}
+
+/// Formats the arguments of a message record.
+std::string formatMessage(Reader& reader, const std::string& fmt) {
+  auto argCount = reader.read<uint8_t>();
+  if (argCount == 0) {
+    return fmt;
+  }
+  boost::format f(fmt);
+  for (uint8_t i = 0; i < argCount; ++i) {
+    switch (static_cast<binary::ArgType>(reader.read<uint8_t>())) {
+    case binary::ArgType::Int:
+      f % reader.read<int64_t>();
+      break;
+    case binary::ArgType::UInt:
+      f % reader.read<uint64_t>();
+      break;
+    case binary::ArgType::Double:
+      f % reader.read<double>();
+      break;
+    case binary::ArgType::String:
+      f % reader.readString();
+      break;
+    default:
+      throw std::runtime_error("unknown argument type");
+    }
+  }
+  return f.str();
+}
+
+void decode(std::istream& in, std::ostream& out) {
+  char magic[binary::MagicSize];
+  if (!in.read(magic, binary::MagicSize) ||
+      std::string(magic, binary::MagicSize) != std::string(binary::Magic, binary::MagicSize)) {
+    throw std::runtime_error("not a binary log");
+  }
+  Reader reader(in);
+  std::vector<std::string> scopes;
+  std::vector<std::string> formats;
+  while (!reader.atEnd()) {
+    switch (static_cast<binary::RecordKind>(reader.read<uint8_t>())) {
+    case binary::RecordKind::Scope: {
+      auto id = reader.read<uint32_t>();
+      define(scopes, id, reader.readString());
+      break;
+    }
+    case binary::RecordKind::Format: {
+      auto id = reader.read<uint32_t>();
+      define(formats, id, reader.readString());
+      break;
+    }
+    case binary::RecordKind::Message: {
+      auto nanoseconds = reader.read<uint64_t>();
+      auto sev = reader.read<uint8_t>();
+      const std::string& scope = lookup(scopes, reader.read<uint32_t>(), "scope");
+      const std::string& fmt = lookup(formats, reader.read<uint32_t>(), "format");
+      std::string msg = formatMessage(reader, fmt);
+      out << boost::format("%1$9.3f %2$-7s [%3$s] %4$s\n") % (nanoseconds * 1e-9) %
+        severityToString(sev) % scope % msg;
+      break;
+    }
+    default:
+      throw std::runtime_error("unknown record kind");
+    }
+  }
+}
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "usage: fmtlog-decode LOGFILE\n";
+    return 2;
+  }
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::cerr << "cannot open " << argv[1] << "\n";
+    return 1;
+  }
+  try {
+    decode(in, std::cout);
+  } catch (const std::exception& ex) {
+    std::cerr << argv[1] << ": " << ex.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
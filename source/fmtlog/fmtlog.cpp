@@ -1,8 +1,18 @@
 #include "fmtlog.hpp"
+#include "ringbuffer.hpp"
 
+#include <fstream>
 #include <iostream>
+#include <atomic>
 #include <chrono>
 #include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 /// Implementation details of the logging library.
 namespace {
@@ -28,18 +38,451 @@ namespace {
     }
     return "UNKOWN";
   }
+
+  /// A log message that has not been written yet.
+  struct Record {
+    /// seconds since the program start
+    double time;
+    fmtlog::Severity severity;
+    std::string scope;
+    std::string message;
+  };
+
+  /// Writes a message in the common output format.
+  void writeLine(std::ostream& out, double time, fmtlog::Severity sev, const std::string& scope,
+             const std::string& msg) {
+    out << boost::format("%1$9.3f %2$-7s [%3$s] %4$s\n") % time % severityToString(sev) % scope % msg;
+  }
+
+  /*! \brief Moves queued records to a sink on a background thread.
+   *
+   *  Producers only touch the lock-free queue and a few atomic counters, the sink is
+   *  exclusively used by the writer thread. The sink provides \c write(R&) for every record
+   *  and \c endBatch(size_t) after each batch, which receives the number of records dropped
+   *  since the previous batch.
+   */
+  template<typename R, typename Sink>
+  class AsyncWriter {
+  public:
+    /*! \brief Starts the writer thread.
+     *  \param capacity the number of records the queue can hold.
+     *  \param overflow how to handle records when the queue is full.
+     *  \param sinkArgs the arguments for constructing the sink.
+     */
+    template<typename... SinkArgs>
+    AsyncWriter(size_t capacity, fmtlog::Overflow overflow, SinkArgs&&... sinkArgs)
+        : m_queue(capacity), m_overflow(overflow), m_sink(std::forward<SinkArgs>(sinkArgs)...),
+          m_thread([this] { run(); }) {}
+
+    /// Writes all pending records and stops the writer thread.
+    ~AsyncWriter() {
+      m_running.store(false, std::memory_order_release);
+      m_thread.join();
+    }
+
+    /*! \brief Queues a record.
+     *  \returns \c false if the record was dropped due to a full queue.
+     */
+    bool push(R& record) {
+      while (!m_queue.tryPush(record)) {
+        if (m_overflow == fmtlog::Overflow::Drop) {
+          m_dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+        std::this_thread::yield();
+      }
+      m_pushed.fetch_add(1, std::memory_order_release);
+      return true;
+    }
+
+    /// Waits until every record queued before the call has been written.
+    void flush() {
+      size_t target = m_pushed.load(std::memory_order_acquire);
+      while (m_written.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+      }
+    }
+
+    size_t dropped() const {
+      return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    /// the sink, only its immutable settings may be used outside of the writer thread
+    const Sink& sink() const {
+      return m_sink;
+    }
+
+  private:
+    void run() {
+      R record;
+      size_t reportedDrops = 0;
+      bool running = true;
+      while (running) {
+        // read the flag before draining, so that nothing queued before stopping is lost
+        running = m_running.load(std::memory_order_acquire);
+        size_t written = 0;
+        while (m_queue.tryPop(record)) {
+          m_sink.write(record);
+          written += 1;
+        }
+        size_t drops = dropped();
+        if (written > 0 || drops != reportedDrops) {
+          m_sink.endBatch(drops - reportedDrops);
+          reportedDrops = drops;
+        }
+        if (written > 0) {
+          m_written.fetch_add(written, std::memory_order_release);
+        } else if (running) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      }
+    }
+
+    fmtlog::internal::RingBuffer<R> m_queue;
+    fmtlog::Overflow m_overflow;
+    Sink m_sink;
+    std::atomic<bool> m_running{true};
+    std::atomic<size_t> m_pushed{0};
+    std::atomic<size_t> m_written{0};
+    std::atomic<size_t> m_dropped{0};
+    // started last, after all members it uses are initialized
+    std::thread m_thread;
+  };
+
+  /// Writes formatted messages to \c stderr.
+  struct TextSink {
+    void write(const Record& record) {
+      writeLine(std::cerr, record.time, record.severity, record.scope, record.message);
+    }
+
+    void endBatch(size_t drops) {
+      if (drops > 0) {
+        std::cerr << boost::format("%1$9s %2$-7s [fmtlog] %3$d messages dropped due to a full queue\n")
+          % "" % severityToString(fmtlog::Severity::Warning) % drops;
+      }
+      std::cerr.flush();
+    }
+  };
+
+  using TextWriter = AsyncWriter<Record, TextSink>;
+
+  /// the active asynchronous writer used by logging threads
+  std::atomic<TextWriter*> ActiveWriter{nullptr};
+
+  /// Owns the asynchronous writer and stops it when the program exits.
+  struct WriterOwner {
+    std::unique_ptr<TextWriter> writer;
+
+    ~WriterOwner() {
+      // logs used in later static destructors fall back to synchronous output
+      ActiveWriter.store(nullptr, std::memory_order_release);
+    }
+  } Writer;
+
+  /// The runtime severity filters of all scopes.
+  struct FilterRegistry {
+    std::mutex mutex;
+    int defaultMinimum = static_cast<int>(fmtlog::Severity::Debug);
+    std::map<std::string, std::unique_ptr<fmtlog::internal::ScopeFilter>> filters;
+    /// the scope names indexed by ScopeFilter::id
+    std::vector<std::string> names;
+  };
+
+  /*! \brief Returns the filter registry.
+   *
+   *  It is created on first use and never destroyed, as logs may be used during static
+   *  initialization and destruction.
+   */
+  FilterRegistry& filterRegistry() {
+    static FilterRegistry* registry = new FilterRegistry;
+    return *registry;
+  }
+
+  /// Returns the name of a scope by its ID.
+  std::string scopeName(uint32_t id) {
+    FilterRegistry& registry = filterRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.names[id];
+  }
+
+  /// An encoded message that has not been written to the binary log yet.
+  struct BinaryRecord {
+    std::chrono::nanoseconds time;
+    fmtlog::Severity severity;
+    uint32_t scope;
+    std::string format;
+    uint8_t argCount;
+    std::string args;
+  };
+
+  /*! \brief Appends encoded messages to a binary log file.
+   *
+   *  Used by the writer thread of an AsyncWriter only. Format strings are identified by their
+   *  content, so buffers reused for different formats are told apart, and equal literals of
+   *  several translation units share one definition. Scope and format definitions are written
+   *  on first use.
+   */
+  class BinarySink {
+  public:
+    BinarySink(const std::string& path, fmtlog::Severity textMinimum)
+        : m_textMinimum(textMinimum) {
+      m_file.rdbuf()->pubsetbuf(m_fileBuffer, sizeof(m_fileBuffer));
+      m_file.open(path, std::ios::binary | std::ios::trunc);
+      if (!m_file) {
+        throw std::runtime_error("cannot open binary log " + path);
+      }
+      m_file.write(fmtlog::binary::Magic, fmtlog::binary::MagicSize);
+    }
+
+    /// messages of at least this severity are also written as text
+    fmtlog::Severity textMinimum() const {
+      return m_textMinimum;
+    }
+
+    /// Writes a message record, preceded by the definitions it refers to.
+    void write(const BinaryRecord& record) {
+      namespace binary = fmtlog::binary;
+      uint32_t scope = record.scope;
+      if (scope >= m_definedScopes.size() || !m_definedScopes[scope]) {
+        m_definedScopes.resize(std::max<size_t>(m_definedScopes.size(), scope + 1), false);
+        m_definedScopes[scope] = true;
+        std::string name = scopeName(scope);
+        m_record.clear();
+        binary::append(m_record, binary::RecordKind::Scope);
+        binary::append(m_record, scope);
+        binary::appendString(m_record, name.data(), name.size());
+        m_file.write(m_record.data(), m_record.size());
+      }
+      auto format = m_formats.find(record.format);
+      if (format == m_formats.end()) {
+        format = m_formats.emplace(record.format, static_cast<uint32_t>(m_formats.size())).first;
+        m_record.clear();
+        binary::append(m_record, binary::RecordKind::Format);
+        binary::append(m_record, format->second);
+        binary::appendString(m_record, record.format.data(), record.format.size());
+        m_file.write(m_record.data(), m_record.size());
+      }
+      m_record.clear();
+      binary::append(m_record, binary::RecordKind::Message);
+      binary::append(m_record, static_cast<uint64_t>(record.time.count()));
+      binary::append(m_record, static_cast<uint8_t>(record.severity));
+      binary::append(m_record, scope);
+      binary::append(m_record, format->second);
+      binary::append(m_record, record.argCount);
+      m_record += record.args;
+      m_file.write(m_record.data(), m_record.size());
+    }
+
+    /// Hands the written records to the operating system, dropped messages are only counted.
+    void endBatch(size_t) {
+      m_file.flush();
+    }
+
+  private:
+    fmtlog::Severity m_textMinimum;
+    char m_fileBuffer[1 << 16];
+    std::ofstream m_file;
+    /// the IDs of the format strings that have been defined in the file
+    std::unordered_map<std::string, uint32_t> m_formats;
+    /// the scopes that have been defined in the file, indexed by ID
+    std::vector<bool> m_definedScopes;
+    /// the record currently being written
+    std::string m_record;
+  };
+
+  using BinaryWriter = AsyncWriter<BinaryRecord, BinarySink>;
+
+  /// the active binary writer used by logging threads
+  std::atomic<BinaryWriter*> ActiveBinaryWriter{nullptr};
+
+  /// the number of threads that may be using the active binary writer
+  std::atomic<size_t> BinaryWriterUsers{0};
+
+  /*! \brief Keeps the active binary writer alive while a logging thread uses it.
+   *
+   *  disableBinary() waits until no thread uses the writer anymore before destroying it.
+   */
+  class BinaryWriterUse {
+  public:
+    BinaryWriterUse() {
+      // announce the use before loading the writer, see fmtlog::disableBinary
+      BinaryWriterUsers.fetch_add(1, std::memory_order_seq_cst);
+      m_writer = ActiveBinaryWriter.load(std::memory_order_seq_cst);
+    }
+
+    ~BinaryWriterUse() {
+      BinaryWriterUsers.fetch_sub(1, std::memory_order_release);
+    }
+
+    BinaryWriterUse(const BinaryWriterUse&) = delete;
+    BinaryWriterUse& operator=(const BinaryWriterUse&) = delete;
+
+    /// the writer, or \c nullptr if binary output is disabled
+    BinaryWriter* get() const {
+      return m_writer;
+    }
+
+  private:
+    BinaryWriter* m_writer;
+  };
+
+  /// Owns the binary writer and closes the file when the program exits.
+  struct BinaryWriterOwner {
+    std::unique_ptr<BinaryWriter> writer;
+
+    ~BinaryWriterOwner() {
+      fmtlog::disableBinary();
+    }
+  } Binary;
+
+  /// The format used for messages that are already formatted.
+  const char* const PreformattedMessage = "%s";
 }
 
 using namespace fmtlog;
 
-Log::Log(const std::string& scope) : m_scope(scope) {}
-Log::Log(const char* scope) : m_scope(scope) {}
+internal::ScopeFilter* internal::scopeFilter(const std::string& scope) {
+  FilterRegistry& registry = filterRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto& filter = registry.filters[scope];
+  if (!filter) {
+    filter.reset(new ScopeFilter);
+    filter->minimum.store(registry.defaultMinimum, std::memory_order_relaxed);
+    filter->explicitMinimum = false;
+    filter->id = static_cast<uint32_t>(registry.names.size());
+    registry.names.push_back(scope);
+  }
+  return filter.get();
+}
+
+void fmtlog::setDefaultSeverity(Severity minimum) {
+  FilterRegistry& registry = filterRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.defaultMinimum = static_cast<int>(minimum);
+  for (auto& entry : registry.filters) {
+    if (!entry.second->explicitMinimum) {
+      entry.second->minimum.store(registry.defaultMinimum, std::memory_order_relaxed);
+    }
+  }
+}
+
+void fmtlog::setSeverity(const std::string& scope, Severity minimum) {
+  internal::ScopeFilter* filter = internal::scopeFilter(scope);
+  std::lock_guard<std::mutex> lock(filterRegistry().mutex);
+  filter->explicitMinimum = true;
+  filter->minimum.store(static_cast<int>(minimum), std::memory_order_relaxed);
+}
+
+void fmtlog::enableBinary(const std::string& path, Severity textMinimum, size_t capacity,
+                          Overflow overflow) {
+  disableBinary();
+  Binary.writer.reset(new BinaryWriter(capacity, overflow, path, textMinimum));
+  ActiveBinaryWriter.store(Binary.writer.get(), std::memory_order_seq_cst);
+}
+
+void fmtlog::disableBinary() {
+  ActiveBinaryWriter.store(nullptr, std::memory_order_seq_cst);
+  // a thread that still loaded the writer has announced itself before, wait until it is done
+  while (BinaryWriterUsers.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+  Binary.writer.reset();
+}
+
+bool internal::binaryOutputActive() {
+  return ActiveBinaryWriter.load(std::memory_order_relaxed) != nullptr;
+}
+
+std::string& internal::encodeBuffer() {
+  thread_local std::string buffer;
+  return buffer;
+}
+
+void fmtlog::enableAsync(size_t capacity, Overflow overflow) {
+  disableAsync();
+  Writer.writer.reset(new TextWriter(capacity, overflow));
+  ActiveWriter.store(Writer.writer.get(), std::memory_order_release);
+}
+
+void fmtlog::disableAsync() {
+  ActiveWriter.store(nullptr, std::memory_order_release);
+  Writer.writer.reset();
+}
+
+void fmtlog::flush() {
+  TextWriter* writer = ActiveWriter.load(std::memory_order_acquire);
+  if (writer) {
+    writer->flush();
+  }
+  BinaryWriterUse binary;
+  if (binary.get()) {
+    binary.get()->flush();
+  }
+}
+
+size_t fmtlog::droppedMessages() {
+  TextWriter* writer = ActiveWriter.load(std::memory_order_acquire);
+  BinaryWriterUse binary;
+  return (writer ? writer->dropped() : 0) + (binary.get() ? binary.get()->dropped() : 0);
+}
+
+Log::Log(const std::string& scope) : m_scope(scope), m_filter(internal::scopeFilter(m_scope)) {}
+Log::Log(const char* scope) : m_scope(scope), m_filter(internal::scopeFilter(m_scope)) {}
 
 void Log::message(Severity sev, const std::string& msg) {
-  // TODO: do something more clever with log entries
+  if (enabled(sev)) {
+    if (internal::binaryOutputActive()) {
+      std::string& encoded = internal::encodeBuffer();
+      encoded.clear();
+      internal::encodeArg(encoded, msg);
+      if (!writeBinary(sev, PreformattedMessage, 1, encoded)) {
+        return;
+      }
+    }
+    write(sev, msg);
+  }
+}
+
+bool Log::writeBinary(Severity sev, const char* fmt, uint8_t argCount, const std::string& args) {
+  BinaryWriterUse use;
+  BinaryWriter* writer = use.get();
+  if (!writer) {
+    // binary output was disabled in the meantime
+    return true;
+  }
+  auto sinceProgramStart = std::chrono::steady_clock::now() - ProgramStartTime;
+  BinaryRecord record{std::chrono::duration_cast<std::chrono::nanoseconds>(sinceProgramStart),
+                      sev, m_filter->id, fmt, argCount, args};
+  if (!writer->push(record)) {
+    // a fatal message must not be lost, it is written as text instead
+    return sev == Severity::Fatal;
+  }
+  if (sev == Severity::Fatal) {
+    // the program is likely about to terminate, write the log file
+    writer->flush();
+  }
+  return sev >= writer->sink().textMinimum();
+}
+
+void Log::write(Severity sev, const std::string& msg) {
   auto curTime = std::chrono::steady_clock::now();
   std::chrono::duration<double, std::ratio<1>> sinceProgramStart = curTime - ProgramStartTime;
 
-  std::cerr << boost::format("%1$9.3f %2$-7s [%3$s] %4$s\n") % sinceProgramStart.count() %
-    severityToString(sev) % m_scope % msg;
+  TextWriter* writer = ActiveWriter.load(std::memory_order_acquire);
+  if (writer) {
+    Record record{sinceProgramStart.count(), sev, m_scope, msg};
+    if (writer->push(record)) {
+      if (sev == Severity::Fatal) {
+        // the program is likely about to terminate, do not lose the message
+        writer->flush();
+      }
+      return;
+    }
+    if (sev != Severity::Fatal) {
+      return;
+    }
+    // a fatal message must not be dropped, write it directly after the pending ones
+    writer->flush();
+  }
+  writeLine(std::cerr, sinceProgramStart.count(), sev, m_scope, msg);
 }
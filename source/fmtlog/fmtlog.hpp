@@ -3,9 +3,26 @@
  */
 #pragma once
 
+#include "binaryformat.hpp"
+
 #include <boost/format.hpp>
 #include <boost/type_index.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
 #include <string>
+#include <type_traits>
+
+/*! \brief The minimum severity of messages compiled into the program, as an integer.
+ *
+ *  Messages below this severity are removed at compile time, neither their formatting
+ *  nor the runtime filter check remain. The value corresponds to the order of fmtlog::Severity,
+ *  i.e. \c 0 keeps all messages and \c 1 removes debug messages.
+ */
+#ifndef FMTLOG_MIN_SEVERITY
+#define FMTLOG_MIN_SEVERITY 0
+#endif
 
 /*! \brief Namespace containing the logging functions.
  */
@@ -43,12 +60,191 @@ enum class Severity {
   Fatal
 };
 
+/// The minimum severity of messages compiled into the program, see FMTLOG_MIN_SEVERITY.
+constexpr Severity CompiledSeverity = static_cast<Severity>(FMTLOG_MIN_SEVERITY);
+
+/*! \brief Sets the minimum severity of messages written by scopes without an explicit filter.
+ *
+ *  The default is Severity::Debug.
+ *  \param minimum messages below this severity are discarded before formatting.
+ */
+void setDefaultSeverity(Severity minimum);
+
+/*! \brief Sets the minimum severity of messages written by a specific scope.
+ *
+ *  The filter applies to all existing and future logs with that scope name.
+ *  \param scope the name of the scope, e.g. as produced by For.
+ *  \param minimum messages below this severity are discarded before formatting.
+ */
+void setSeverity(const std::string& scope, Severity minimum);
+
+/*! \brief Determines what happens to a message when the asynchronous queue is full.
+ */
+enum class Overflow {
+  /// The message is discarded and counted, the caller never waits.
+  Drop,
+  /// The caller waits until the writer thread has made room for the message.
+  Block
+};
+
+/*! \brief Switches all logs to asynchronous output.
+ *
+ *  Afterwards, messages are put into a bounded lock-free queue and written to \c stderr
+ *  by a background thread, so that logging does not wait for the output stream.
+ *  Messages of severity Severity::Fatal are still written before the call returns.
+ *  If asynchronous output is already enabled, it is restarted with the new settings.
+ *
+ *  \note Must not be called while other threads are logging.
+ *  \param capacity the number of messages the queue can hold.
+ *  \param overflow how to handle messages when the queue is full.
+ */
+void enableAsync(size_t capacity = 8192, Overflow overflow = Overflow::Drop);
+
+/*! \brief Writes all pending messages and returns to synchronous output.
+ *
+ *  This happens automatically when the program exits.
+ *  \note Must not be called while other threads are logging.
+ */
+void disableAsync();
+
+/*! \brief Blocks until all messages logged so far have been written.
+ *
+ *  Does nothing when neither asynchronous nor binary output is enabled.
+ */
+void flush();
+
+/// The number of messages discarded because the asynchronous or binary queue was full.
+size_t droppedMessages();
+
+/*! \brief Writes messages to a binary log file instead of formatting them.
+ *
+ *  Messages are stored with their format string ID and raw argument values, see
+ *  binaryformat.hpp, and formatted later by the \c fmtlog-decode tool. This is much cheaper
+ *  than text output, so that debug messages can stay enabled. Logging threads only encode
+ *  the arguments and put the record into a bounded lock-free queue, the file is written by
+ *  a background thread like the asynchronous text output.
+ *  Messages of severity Severity::Fatal are written before the call returns.
+ *  If binary output is already enabled, the previous file is closed.
+ *
+ *  \param path the file to write to, it is overwritten.
+ *  \param textMinimum messages of at least this severity are also written as text.
+ *  \param capacity the number of messages the queue can hold.
+ *  \param overflow how to handle messages when the queue is full.
+ *  \throws std::runtime_error if the file cannot be opened.
+ */
+void enableBinary(const std::string& path, Severity textMinimum = Severity::Warning,
+                  size_t capacity = 8192, Overflow overflow = Overflow::Drop);
+
+/*! \brief Writes all pending messages, closes the binary log file and returns to text output.
+ *
+ *  Waits until threads that are currently logging are done with the file.
+ *  This happens automatically when the program exits.
+ */
+void disableBinary();
+
 /*! \brief Implements internal helper function used by the logging facilites.
  *
  *  Not intended for use outside of fmtlog.
  */
 namespace internal {
 
+/*! \brief The runtime filter shared by all logs with the same scope name.
+ *
+ *  Filters are created once per scope name and never destroyed.
+ */
+struct ScopeFilter {
+  /// the minimum severity as an integer
+  std::atomic<int> minimum;
+  /// whether the minimum was set for this scope, or follows the default severity
+  bool explicitMinimum;
+  /// identifies the scope in binary logs
+  uint32_t id;
+};
+
+/// Whether messages are currently written to a binary log.
+bool binaryOutputActive();
+
+/// A per-thread buffer for encoding message arguments.
+std::string& encodeBuffer();
+
+/// Encodes a string argument for binary logs.
+inline void encodeArg(std::string& out, const char* value) {
+  binary::append(out, binary::ArgType::String);
+  binary::appendString(out, value, std::strlen(value));
+}
+
+/// \copydoc encodeArg(std::string&, const char*)
+inline void encodeArg(std::string& out, const std::string& value) {
+  binary::append(out, binary::ArgType::String);
+  binary::appendString(out, value.data(), value.size());
+}
+
+/// Encodes a character argument as a string, so that it is printed as a character.
+inline void encodeArg(std::string& out, char value) {
+  binary::append(out, binary::ArgType::String);
+  binary::appendString(out, &value, 1);
+}
+
+/// Encodes a signed integer argument for binary logs.
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+encodeArg(std::string& out, T value) {
+  binary::append(out, binary::ArgType::Int);
+  binary::append(out, static_cast<int64_t>(value));
+}
+
+/// Encodes an unsigned integer argument for binary logs.
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+encodeArg(std::string& out, T value) {
+  binary::append(out, binary::ArgType::UInt);
+  binary::append(out, static_cast<uint64_t>(value));
+}
+
+/// Encodes a floating point argument for binary logs.
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+encodeArg(std::string& out, T value) {
+  binary::append(out, binary::ArgType::Double);
+  binary::append(out, static_cast<double>(value));
+}
+
+/// Encodes any other argument by its stream output, as boost::format would print it.
+template<typename T>
+inline typename std::enable_if<!std::is_arithmetic<T>::value &&
+                               !std::is_convertible<const T&, const char*>::value &&
+                               !std::is_same<T, std::string>::value>::type
+encodeArg(std::string& out, const T& value) {
+  std::ostringstream stream;
+  stream << value;
+  encodeArg(out, stream.str());
+}
+
+/// Encodes no arguments.
+inline void encodeArgs(std::string&) {}
+
+/*! \brief Encodes message arguments for binary logs.
+ *  \param out the buffer the encoded arguments are appended to
+ *  \param first the first argument
+ *  \param args the remaining arguments
+ */
+template<typename First, typename... Args>
+inline void encodeArgs(std::string& out, const First& first, const Args&... args) {
+  encodeArg(out, first);
+  encodeArgs(out, args...);
+}
+
+/// Returns the filter of a scope, creating it if necessary.
+ScopeFilter* scopeFilter(const std::string& scope);
+
+/*! \brief Formats a message without arguments.
+ *
+ *  The format string is used literally, so that it may contain percent signs.
+ */
+inline std::string format(const char* fmt) {
+  return fmt;
+}
+
 /*! \brief Passes values to boost::format from a variadic template.
  *
  *  \param fmt a reference to the format object
@@ -76,6 +272,23 @@ inline void formatWithArgs(boost::format& fmt, First&& first, Args&&... args) {
   fmt % std::forward<First>(first);
   formatWithArgs(fmt, std::forward<Args>(args)...);
 }
+
+/*! \brief Formats a message with at least one argument using boost::format.
+ *
+ *  \param fmt the format string
+ *  \param first the first format argument
+ *  \param args the remaining format arguments
+ */
+template<typename First, typename... Args>
+inline std::string format(const char* fmt, First&& first, Args&&... args) {
+  boost::format f(fmt);
+  formatWithArgs(f, std::forward<First>(first), std::forward<Args>(args)...);
+  return boost::str(f);
+}
+
+/// Whether messages of severity \c Sev are compiled into the program.
+template<Severity Sev>
+using Compiled = std::integral_constant<bool, (Sev >= CompiledSeverity)>;
 }
 
 /*! \brief Helper class for getting the name of a class.
@@ -95,7 +308,9 @@ struct For {
 
 /*! \brief A scoped log target.
  *
- *  \todo Provide global Log configuration like severity filters.
+ *  Messages are filtered by severity before they are formatted: at compile time
+ *  by FMTLOG_MIN_SEVERITY, and at runtime by setDefaultSeverity and setSeverity.
+ *
  *  \todo Implement log file instead of using stderr.
  */
 class Log {
@@ -114,6 +329,16 @@ public:
    */
   Log(const char* scope);
 
+  /*! \brief Checks whether messages of a severity pass the filters of this scope.
+   *
+   *  \param sev the severity of a message
+   *  \returns \c false if a message of this severity would be discarded.
+   */
+  bool enabled(Severity sev) const {
+    return sev >= CompiledSeverity &&
+           static_cast<int>(sev) >= m_filter->minimum.load(std::memory_order_relaxed);
+  }
+
   /*! \brief Emits a log message.
    *
    *  \param sev the severity of the message
@@ -123,16 +348,26 @@ public:
 
   /*! \brief Emits a formatted log message.
    *
-   *  The formatting relies on the Boost format library.
+   *  The formatting relies on the Boost format library. It only takes place if the message
+   *  passes the severity filters.
    *  \param sev the severity of the message
    *  \param fmt the format string for producing the log message.
    *  \param args formatting arguments.
    */
   template <typename... Args>
-  void message(Severity sev, const std::string& fmt, Args&&... args) {
-    boost::format f(fmt);
-    internal::formatWithArgs(f, std::forward<Args>(args)...);
-    message(sev, boost::str(f));
+  void message(Severity sev, const char* fmt, Args&&... args) {
+    static_assert(sizeof...(Args) < 256, "too many log arguments");
+    if (enabled(sev)) {
+      if (internal::binaryOutputActive()) {
+        std::string& encoded = internal::encodeBuffer();
+        encoded.clear();
+        internal::encodeArgs(encoded, args...);
+        if (!writeBinary(sev, fmt, sizeof...(Args), encoded)) {
+          return;
+        }
+      }
+      write(sev, internal::format(fmt, std::forward<Args>(args)...));
+    }
   }
 
   /*! \brief Emits a debug log message.
@@ -142,8 +377,8 @@ public:
    *  \see Log::message
    */
   template<typename... Args>
-  void debug(const std::string& fmt, Args&&... args) {
-    message(Severity::Debug, fmt, std::forward<Args>(args)...);
+  void debug(const char* fmt, Args&&... args) {
+    filtered(internal::Compiled<Severity::Debug>(), Severity::Debug, fmt, std::forward<Args>(args)...);
   }
 
   /*! \brief Emits an info log message.
@@ -153,8 +388,8 @@ public:
    *  \see Log::message
    */
   template<typename... Args>
-  void info(const std::string& fmt, Args&&... args) {
-    message(Severity::Info, fmt, std::forward<Args>(args)...);
+  void info(const char* fmt, Args&&... args) {
+    filtered(internal::Compiled<Severity::Info>(), Severity::Info, fmt, std::forward<Args>(args)...);
   }
 
   /*! \brief Emits a warning log message.
@@ -164,8 +399,8 @@ public:
    *  \see Log::message
    */
   template<typename... Args>
-  void warning(const std::string& fmt, Args&&... args) {
-    message(Severity::Warning, fmt, std::forward<Args>(args)...);
+  void warning(const char* fmt, Args&&... args) {
+    filtered(internal::Compiled<Severity::Warning>(), Severity::Warning, fmt, std::forward<Args>(args)...);
   }
 
   /*! \brief Emits an error log message.
@@ -175,8 +410,8 @@ public:
    *  \see Log::message
    */
   template<typename... Args>
-  void error(const std::string& fmt, Args&&... args) {
-    message(Severity::Error, fmt, std::forward<Args>(args)...);
+  void error(const char* fmt, Args&&... args) {
+    filtered(internal::Compiled<Severity::Error>(), Severity::Error, fmt, std::forward<Args>(args)...);
   }
 
   /*! \brief Emits a fatal log message.
@@ -186,12 +421,37 @@ public:
    *  \see Log::message
    */
   template<typename... Args>
-  void fatal(const std::string& fmt, Args&&... args) {
-    message(Severity::Fatal, fmt, std::forward<Args>(args)...);
+  void fatal(const char* fmt, Args&&... args) {
+    filtered(internal::Compiled<Severity::Fatal>(), Severity::Fatal, fmt, std::forward<Args>(args)...);
   }
 
 private:
+  /// Emits a message whose severity is compiled in.
+  template<typename... Args>
+  void filtered(std::true_type, Severity sev, const char* fmt, Args&&... args) {
+    message(sev, fmt, std::forward<Args>(args)...);
+  }
+
+  /// Discards a message whose severity is not compiled in.
+  template<typename... Args>
+  void filtered(std::false_type, Severity, const char*, Args&&...) {}
+
+  /// Writes a message that already passed the filters.
+  void write(Severity sev, const std::string& msg);
+
+  /*! \brief Writes a message that already passed the filters to the binary log.
+   *
+   *  \param sev the severity of the message
+   *  \param fmt the format string
+   *  \param argCount the number of encoded arguments
+   *  \param args the encoded arguments
+   *  \returns \c true if the message should also be written as text.
+   */
+  bool writeBinary(Severity sev, const char* fmt, uint8_t argCount, const std::string& args);
+
   /// the name of the log scope
   std::string m_scope;
+  /// the severity filter of the scope
+  internal::ScopeFilter* m_filter;
 };
 }
@@ -0,0 +1,109 @@
+/*! \file
+ *  \brief Defines the bounded lock-free queue used by the asynchronous log backend.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace fmtlog {
+namespace internal {
+
+/*! \brief A bounded multi-producer multi-consumer queue that never blocks.
+ *
+ *  Each slot carries a sequence number telling whether it is ready to be written or read
+ *  in the current round, so producers and consumers only synchronize through atomics
+ *  (D. Vyukov's bounded MPMC queue).
+ */
+template<typename T>
+class RingBuffer {
+public:
+  /*! \brief Creates an empty queue.
+   *  \param capacity the minimum number of elements, rounded up to a power of two.
+   */
+  explicit RingBuffer(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size *= 2;
+    }
+    m_mask = size - 1;
+    m_slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; ++i) {
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  /// the number of elements the queue can hold
+  size_t capacity() const {
+    return m_mask + 1;
+  }
+
+  /*! \brief Appends an element unless the queue is full.
+   *  \returns \c true if the element was added, \c false if the queue was full, in which case
+   *  \p value is left untouched.
+   */
+  bool tryPush(T& value) {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = m_slots[pos & m_mask];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          slot.value = std::move(value);
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /*! \brief Removes the oldest element unless the queue is empty.
+   *  \returns \c true if an element was moved to \p value, \c false if the queue was empty.
+   */
+  bool tryPop(T& value) {
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = m_slots[pos & m_mask];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          value = std::move(slot.value);
+          slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Slot[]> m_slots;
+  size_t m_mask;
+  // padding keeps producers and consumers on separate cache lines
+  char m_padding0[64];
+  std::atomic<size_t> m_enqueuePos{0};
+  char m_padding1[64];
+  std::atomic<size_t> m_dequeuePos{0};
+};
+}
+}
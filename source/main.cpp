@@ -5,6 +5,8 @@
 #include <boost/type_index.hpp>
 
 int main() {
+  // keep the game loop from waiting on stderr
+  fmtlog::enableAsync();
   fmtlog::Log log("<main>");
   log.info("started");
   try {
@@ -16,5 +18,6 @@ int main() {
     log.fatal("unhandled unkown exception");
   }
   log.info("about to exit");
+  fmtlog::disableAsync();
   return 0;
 }
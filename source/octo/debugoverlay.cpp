@@ -6,6 +6,8 @@
 #include <SFML/Graphics.hpp>
 #include <boost/format.hpp>
 
+#include <string>
+
 namespace octo {
 
 void DebugOverlay::draw(sf::RenderTarget& target) {
@@ -16,7 +18,20 @@ void DebugOverlay::draw(sf::RenderTarget& target) {
     sf::Text fpsText;
     fpsText.setFont(m_font->content());
     fpsText.setCharacterSize(16);
-    fpsText.setString((boost::format("FPS: %.1f") % m_fps.fps()).str());
+    std::string text = (boost::format("FPS: %.1f") % m_fps.fps()).str();
+    if (m_statistics) {
+      for (const auto& timing : m_statistics->timings()) {
+        text += (boost::format("\n%-16s %7.3f ms (max %7.3f ms)")
+                 % timing.name % (timing.seconds.average() * 1000) % (timing.seconds.max() * 1000)).str();
+      }
+      for (size_t i = 0; i < game::Statistics::CounterCount; ++i) {
+        auto counter = static_cast<game::Statistics::Counter>(i);
+        const game::RollingSeries& series = m_statistics->counter(counter);
+        text += (boost::format("\n%-16s %9.1f (max %9.0f)")
+                 % game::Statistics::counterName(counter) % series.average() % series.max()).str();
+      }
+    }
+    fpsText.setString(text);
     fpsText.setFillColor(sf::Color::White);
     fpsText.setPosition(5, 5);
     target.draw(fpsText);
@@ -42,4 +57,8 @@ const std::shared_ptr<content::FontContent>& DebugOverlay::font() const {
 void DebugOverlay::setFont(std::shared_ptr<content::FontContent> font) {
   m_font = std::move(font);
 }
+
+void DebugOverlay::setStatistics(const game::Statistics* statistics) {
+  m_statistics = statistics;
+}
 }
@@ -2,6 +2,7 @@
 
 #include <octo/util/fpscounter.hpp>
 #include <octo/content/font.hpp>
+#include <octo/game/statistics.hpp>
 
 #include <SFML/Graphics/RenderTarget.hpp>
 
@@ -24,8 +25,16 @@ public:
 
   void setFont(std::shared_ptr<content::FontContent> font);
 
+  /*! \brief Sets the simulation statistics shown below the frame rate.
+   *
+   *  \param statistics the statistics, or \c nullptr to hide them. The statistics must stay
+   *  alive until they are replaced or removed.
+   */
+  void setStatistics(const game::Statistics* statistics);
+
 private:
   std::shared_ptr<content::FontContent> m_font;
+  const game::Statistics* m_statistics = nullptr;
   util::FpsCounter m_fps;
   bool m_active = true;
 };
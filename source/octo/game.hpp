@@ -142,6 +142,13 @@ public:
     return m_content;
   }
 
+  /*! \brief Returns a reference to the debug overlay drawn on top of the game states.
+   *  \returns a reference to the debug overlay
+   */
+  DebugOverlay& debugOverlay() {
+    return m_debugOverlay;
+  }
+
 private:
   /// Game scope logger
   fmtlog::Log log = fmtlog::For<Game>();
@@ -0,0 +1,250 @@
+#include "aabbtree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+namespace {
+/// the smallest box containing both \p a and \p b
+sf::FloatRect merge(const sf::FloatRect& a, const sf::FloatRect& b) {
+  float left = std::min(a.left, b.left);
+  float top = std::min(a.top, b.top);
+  float right = std::max(a.left + a.width, b.left + b.width);
+  float bottom = std::max(a.top + a.height, b.top + b.height);
+  return {left, top, right - left, bottom - top};
+}
+
+/// the cost measure of a box, in 2D the perimeter takes the role of the surface area
+float perimeter(const sf::FloatRect& r) {
+  return 2 * (r.width + r.height);
+}
+
+bool contains(const sf::FloatRect& outer, const sf::FloatRect& inner) {
+  return outer.left <= inner.left && outer.top <= inner.top &&
+         inner.left + inner.width <= outer.left + outer.width &&
+         inner.top + inner.height <= outer.top + outer.height;
+}
+}
+
+constexpr AabbTree::Proxy AabbTree::Null;
+
+AabbTree::AabbTree(float margin) : m_margin(margin) {}
+
+AabbTree::Proxy AabbTree::insert(const sf::FloatRect& aabb, std::uint64_t data) {
+  Proxy leaf = allocateNode();
+  Node& node = m_nodes[leaf];
+  node.aabb = {aabb.left - m_margin,
+               aabb.top - m_margin,
+               aabb.width + 2 * m_margin,
+               aabb.height + 2 * m_margin};
+  node.data = data;
+  node.height = 0;
+  insertLeaf(leaf);
+  ++m_size;
+  return leaf;
+}
+
+void AabbTree::remove(Proxy proxy) {
+  assert(m_nodes[proxy].isLeaf());
+  removeLeaf(proxy);
+  freeNode(proxy);
+  --m_size;
+}
+
+bool AabbTree::move(Proxy proxy, const sf::FloatRect& aabb) {
+  assert(m_nodes[proxy].isLeaf());
+  if (contains(m_nodes[proxy].aabb, aabb)) {
+    return false;
+  }
+  removeLeaf(proxy);
+  m_nodes[proxy].aabb = {aabb.left - m_margin,
+                         aabb.top - m_margin,
+                         aabb.width + 2 * m_margin,
+                         aabb.height + 2 * m_margin};
+  insertLeaf(proxy);
+  return true;
+}
+
+void AabbTree::clear() {
+  m_nodes.clear();
+  m_root = Null;
+  m_freeList = Null;
+  m_size = 0;
+}
+
+size_t AabbTree::size() const {
+  return m_size;
+}
+
+int AabbTree::height() const {
+  return m_root == Null ? 0 : m_nodes[m_root].height;
+}
+
+std::uint64_t AabbTree::data(Proxy proxy) const {
+  return m_nodes[proxy].data;
+}
+
+const sf::FloatRect& AabbTree::fatAabb(Proxy proxy) const {
+  return m_nodes[proxy].aabb;
+}
+
+AabbTree::Proxy AabbTree::allocateNode() {
+  Proxy node;
+  if (m_freeList == Null) {
+    node = m_nodes.size();
+    m_nodes.emplace_back();
+  } else {
+    node = m_freeList;
+    m_freeList = m_nodes[node].parent;
+  }
+  m_nodes[node].parent = Null;
+  m_nodes[node].child1 = Null;
+  m_nodes[node].child2 = Null;
+  m_nodes[node].height = 0;
+  return node;
+}
+
+void AabbTree::freeNode(Proxy node) {
+  m_nodes[node].parent = m_freeList;
+  m_nodes[node].height = -1;
+  m_freeList = node;
+}
+
+void AabbTree::insertLeaf(Proxy leaf) {
+  if (m_root == Null) {
+    m_root = leaf;
+    m_nodes[leaf].parent = Null;
+    return;
+  }
+
+  // descend to the sibling for which the enclosing boxes grow the least
+  const sf::FloatRect box = m_nodes[leaf].aabb;
+  Proxy index = m_root;
+  while (!m_nodes[index].isLeaf()) {
+    const Node& node = m_nodes[index];
+    float area = perimeter(node.aabb);
+    float combinedArea = perimeter(merge(node.aabb, box));
+    // the cost of creating a new parent for this node and the leaf
+    float cost = 2 * combinedArea;
+    // the minimum cost of pushing the leaf further down, paid by all ancestors below this node
+    float inheritanceCost = 2 * (combinedArea - area);
+    auto descendCost = [&](Proxy child) {
+      const Node& c = m_nodes[child];
+      float merged = perimeter(merge(c.aabb, box));
+      return (c.isLeaf() ? merged : merged - perimeter(c.aabb)) + inheritanceCost;
+    };
+    float cost1 = descendCost(node.child1);
+    float cost2 = descendCost(node.child2);
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  // create a new parent for the sibling and the leaf
+  Proxy sibling = index;
+  Proxy oldParent = m_nodes[sibling].parent;
+  Proxy newParent = allocateNode();
+  replaceChild(oldParent, sibling, newParent);
+  m_nodes[newParent].parent = oldParent;
+  m_nodes[newParent].child1 = sibling;
+  m_nodes[newParent].child2 = leaf;
+  m_nodes[sibling].parent = newParent;
+  m_nodes[leaf].parent = newParent;
+
+  // fix heights and boxes of the ancestors
+  for (index = newParent; index != Null; index = m_nodes[index].parent) {
+    refit(index);
+    index = balance(index);
+  }
+}
+
+void AabbTree::removeLeaf(Proxy leaf) {
+  if (leaf == m_root) {
+    m_root = Null;
+    return;
+  }
+  Proxy parent = m_nodes[leaf].parent;
+  Proxy grandParent = m_nodes[parent].parent;
+  Proxy sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+  // the sibling takes the place of the parent
+  replaceChild(grandParent, parent, sibling);
+  m_nodes[sibling].parent = grandParent;
+  freeNode(parent);
+
+  for (Proxy index = grandParent; index != Null; index = m_nodes[index].parent) {
+    refit(index);
+    index = balance(index);
+  }
+}
+
+void AabbTree::refit(Proxy node) {
+  Node& n = m_nodes[node];
+  const Node& child1 = m_nodes[n.child1];
+  const Node& child2 = m_nodes[n.child2];
+  n.aabb = merge(child1.aabb, child2.aabb);
+  n.height = 1 + std::max(child1.height, child2.height);
+}
+
+void AabbTree::replaceChild(Proxy parent, Proxy from, Proxy to) {
+  if (parent == Null) {
+    m_root = to;
+  } else if (m_nodes[parent].child1 == from) {
+    m_nodes[parent].child1 = to;
+  } else {
+    m_nodes[parent].child2 = to;
+  }
+}
+
+AabbTree::Proxy AabbTree::balance(Proxy node) {
+  const Node& n = m_nodes[node];
+  if (n.isLeaf() || n.height < 2) {
+    return node;
+  }
+  int imbalance = m_nodes[n.child2].height - m_nodes[n.child1].height;
+  if (imbalance > 1) {
+    return rotate(node, n.child2);
+  }
+  if (imbalance < -1) {
+    return rotate(node, n.child1);
+  }
+  return node;
+}
+
+AabbTree::Proxy AabbTree::rotate(Proxy node, Proxy up) {
+  Node& a = m_nodes[node];
+  Node& b = m_nodes[up];
+  Proxy taller = b.child1;
+  Proxy shorter = b.child2;
+  if (m_nodes[taller].height < m_nodes[shorter].height) {
+    std::swap(taller, shorter);
+  }
+
+  // the promoted child takes the place of the node
+  replaceChild(a.parent, node, up);
+  b.parent = a.parent;
+
+  // the node becomes a child of the promoted one, next to the taller grandchild,
+  // and adopts the shorter grandchild in place of the promoted one
+  b.child1 = node;
+  b.child2 = taller;
+  a.parent = up;
+  if (a.child1 == up) {
+    a.child1 = shorter;
+  } else {
+    a.child2 = shorter;
+  }
+  m_nodes[shorter].parent = node;
+
+  refit(node);
+  refit(up);
+  return up;
+}
+
+}
+}
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/*! \brief A dynamic bounding volume hierarchy of axis aligned bounding boxes.
+ *
+ *  Every object is stored as a leaf with a box enlarged by a margin (a "fat" box). Moving an
+ *  object only touches the tree when its box leaves the fat box, so objects moving a little or
+ *  not at all cost nothing. Leaves are inserted next to the sibling minimizing the perimeter
+ *  of the enclosing boxes, and the tree is kept balanced by rotations like an AVL tree.
+ */
+class AabbTree {
+public:
+  /// Identifies an object stored in the tree.
+  using Proxy = size_t;
+
+  /// The proxy of no node.
+  static constexpr Proxy Null = std::numeric_limits<Proxy>::max();
+
+  /*! \brief Initializes an empty tree.
+   *  \param margin the distance by which the stored boxes are enlarged on every side.
+   */
+  explicit AabbTree(float margin = 8);
+
+  /*! \brief Stores an object.
+   *
+   *  \param aabb the world space bounding box of the object.
+   *  \param data user data reported by \ref query, e.g. an entity id.
+   *  \return the identifier of the object, which may be reused after the object was removed.
+   */
+  Proxy insert(const sf::FloatRect& aabb, std::uint64_t data);
+
+  /// Removes an object from the tree.
+  void remove(Proxy proxy);
+
+  /*! \brief Updates the bounding box of an object.
+   *
+   *  \param proxy the object to update.
+   *  \param aabb the new world space bounding box of the object.
+   *  \return \c true if the object had to be reinserted, because \p aabb was not contained
+   *  in its fat box.
+   */
+  bool move(Proxy proxy, const sf::FloatRect& aabb);
+
+  /// Removes all objects.
+  void clear();
+
+  /// the number of objects stored
+  size_t size() const;
+
+  /// the height of the tree, zero for a tree with at most one object
+  int height() const;
+
+  /// the user data of an object
+  std::uint64_t data(Proxy proxy) const;
+
+  /// the enlarged bounding box stored for an object
+  const sf::FloatRect& fatAabb(Proxy proxy) const;
+
+  /*! \brief Reports all objects whose fat boxes intersect a given box.
+   *
+   *  Since the fat boxes are larger than the actual ones, callers have to check the actual
+   *  bounding boxes of the reported objects.
+   *
+   *  \param aabb the query box in world coordinates.
+   *  \param callback called as \c callback(proxy, data) for every object found.
+   */
+  template <typename F>
+  void query(const sf::FloatRect& aabb, F callback) const;
+
+private:
+  struct Node {
+    /// the fat box of a leaf, or the union of the children's boxes
+    sf::FloatRect aabb;
+    std::uint64_t data;
+    /// the parent node, or the next free node in the free list
+    Proxy parent;
+    Proxy child1;
+    Proxy child2;
+    /// zero for leaves, -1 for free nodes
+    int height;
+
+    bool isLeaf() const {
+      return child1 == Null;
+    }
+  };
+
+  Proxy allocateNode();
+
+  void freeNode(Proxy node);
+
+  void insertLeaf(Proxy leaf);
+
+  void removeLeaf(Proxy leaf);
+
+  /// Recomputes the box and height of an inner node from its children.
+  void refit(Proxy node);
+
+  /// Replaces the child \p from of \p parent by \p to, or the root if \p parent is Null.
+  void replaceChild(Proxy parent, Proxy from, Proxy to);
+
+  /// Performs a rotation at \p node if it is imbalanced and returns the new root of its subtree.
+  Proxy balance(Proxy node);
+
+  /// Moves the child \p up of \p node into its place and returns it.
+  Proxy rotate(Proxy node, Proxy up);
+
+  float m_margin;
+  Proxy m_root = Null;
+  Proxy m_freeList = Null;
+  size_t m_size = 0;
+  std::vector<Node> m_nodes;
+};
+
+template <typename F>
+void AabbTree::query(const sf::FloatRect& aabb, F callback) const {
+  if (m_root == Null) {
+    return;
+  }
+  std::vector<Proxy> stack;
+  stack.reserve(64);
+  stack.push_back(m_root);
+  while (!stack.empty()) {
+    const Node& node = m_nodes[stack.back()];
+    Proxy index = stack.back();
+    stack.pop_back();
+    if (node.aabb.intersects(aabb)) {
+      if (node.isLeaf()) {
+        callback(index, node.data);
+      } else {
+        stack.push_back(node.child1);
+        stack.push_back(node.child2);
+      }
+    }
+  }
+}
+
+}
+}
+}
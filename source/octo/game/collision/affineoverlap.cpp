@@ -0,0 +1,199 @@
+#include "affineoverlap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace octo {
+namespace game {
+namespace collision {
+
+namespace {
+/// the number of pixels whose positions are computed at once, the bits of a word
+const size_t ChunkSize = 64;
+
+/*! \brief Positions closer than this to a rounding boundary are transformed exactly.
+ *
+ *  The incrementally computed positions are off by about 1e-4 pixels for masks of
+ *  a few thousand pixels, which is well below this tolerance.
+ */
+const float Tolerance = 1.f / 64;
+
+/// The positions in \p a of a chunk of consecutive pixels of \p b.
+struct Chunk {
+  std::int32_t x[ChunkSize];
+  std::int32_t y[ChunkSize];
+  /// bit \c i is set if the position of pixel \c i must be transformed exactly
+  sf::Uint64 inexact;
+};
+
+/*! \brief Computes the rounded positions of \p count pixels starting at \p (u, v) in steps of \p (du, dv).
+ */
+void computeChunk(double u, double v, float du, float dv, size_t count, Chunk& chunk) {
+  chunk.inexact = 0;
+#if defined(__AVX__)
+  const __m256 lanes = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256 u0 = _mm256_set1_ps(static_cast<float>(u));
+  const __m256 v0 = _mm256_set1_ps(static_cast<float>(v));
+  const __m256 du8 = _mm256_set1_ps(du);
+  const __m256 dv8 = _mm256_set1_ps(dv);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 tolerance = _mm256_set1_ps(Tolerance);
+  const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  for (size_t i = 0; i < count; i += 8) {
+    __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lanes);
+    __m256 pu = _mm256_add_ps(u0, _mm256_mul_ps(index, du8));
+    __m256 pv = _mm256_add_ps(v0, _mm256_mul_ps(index, dv8));
+    __m256 ru = _mm256_floor_ps(_mm256_add_ps(pu, half));
+    __m256 rv = _mm256_floor_ps(_mm256_add_ps(pv, half));
+    // the distance to the rounding boundary is |p - round(p)| compared to 0.5
+    __m256 distU = _mm256_sub_ps(half, _mm256_and_ps(_mm256_sub_ps(pu, ru), absMask));
+    __m256 distV = _mm256_sub_ps(half, _mm256_and_ps(_mm256_sub_ps(pv, rv), absMask));
+    __m256 inexact = _mm256_or_ps(_mm256_cmp_ps(distU, tolerance, _CMP_LT_OQ),
+                                  _mm256_cmp_ps(distV, tolerance, _CMP_LT_OQ));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.x + i), _mm256_cvttps_epi32(ru));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.y + i), _mm256_cvttps_epi32(rv));
+    chunk.inexact |= static_cast<sf::Uint64>(_mm256_movemask_ps(inexact)) << i;
+  }
+#elif defined(__SSE2__)
+  const __m128 lanes = _mm_setr_ps(0, 1, 2, 3);
+  const __m128 u0 = _mm_set1_ps(static_cast<float>(u));
+  const __m128 v0 = _mm_set1_ps(static_cast<float>(v));
+  const __m128 du4 = _mm_set1_ps(du);
+  const __m128 dv4 = _mm_set1_ps(dv);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 one = _mm_set1_ps(1.f);
+  const __m128 tolerance = _mm_set1_ps(Tolerance);
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  // SSE2 has no floor, truncation rounds negative values up and is corrected by one
+  auto floor = [one](__m128 p) {
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(p));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, p), one));
+  };
+  for (size_t i = 0; i < count; i += 4) {
+    __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes);
+    __m128 pu = _mm_add_ps(u0, _mm_mul_ps(index, du4));
+    __m128 pv = _mm_add_ps(v0, _mm_mul_ps(index, dv4));
+    __m128 ru = floor(_mm_add_ps(pu, half));
+    __m128 rv = floor(_mm_add_ps(pv, half));
+    // the distance to the rounding boundary is |p - round(p)| compared to 0.5
+    __m128 distU = _mm_sub_ps(half, _mm_and_ps(_mm_sub_ps(pu, ru), absMask));
+    __m128 distV = _mm_sub_ps(half, _mm_and_ps(_mm_sub_ps(pv, rv), absMask));
+    __m128 inexact =
+        _mm_or_ps(_mm_cmplt_ps(distU, tolerance), _mm_cmplt_ps(distV, tolerance));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.x + i), _mm_cvttps_epi32(ru));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.y + i), _mm_cvttps_epi32(rv));
+    chunk.inexact |= static_cast<sf::Uint64>(_mm_movemask_ps(inexact)) << i;
+  }
+#else
+  const float u0 = static_cast<float>(u);
+  const float v0 = static_cast<float>(v);
+  for (size_t i = 0; i < count; ++i) {
+    float pu = u0 + static_cast<float>(i) * du;
+    float pv = v0 + static_cast<float>(i) * dv;
+    float ru = std::floor(pu + 0.5f);
+    float rv = std::floor(pv + 0.5f);
+    chunk.x[i] = static_cast<std::int32_t>(ru);
+    chunk.y[i] = static_cast<std::int32_t>(rv);
+    if (0.5f - std::abs(pu - ru) < Tolerance || 0.5f - std::abs(pv - rv) < Tolerance) {
+      chunk.inexact |= sf::Uint64(1) << i;
+    }
+  }
+#endif
+}
+
+/*! \brief Restricts \p [begin, end) to the steps \c i for which \c p+i*dp lies within \p [low, high].
+ */
+void clip(double p, double dp, double low, double high, std::ptrdiff_t& begin, std::ptrdiff_t& end) {
+  if (dp == 0) {
+    if (p < low || p > high) {
+      end = begin;
+    }
+    return;
+  }
+  double first = (low - p) / dp;
+  double last = (high - p) / dp;
+  if (first > last) {
+    std::swap(first, last);
+  }
+  begin = std::max(begin, static_cast<std::ptrdiff_t>(std::max(std::ceil(first), -1.0)));
+  end = std::min(end, static_cast<std::ptrdiff_t>(std::min(std::floor(last) + 1, 1e15)));
+}
+}
+
+void addOverlap(const Mask& a, const BitMask& b, const sf::Transform& btoa,
+                const sf::Rect<size_t>& region, Overlap& result) {
+  const float* m = btoa.getMatrix();
+  const sf::Rect<size_t> boundsA{{0, 0}, a.size()};
+  // the pixels of a are hit by positions in [-0.5, size - 0.5), with some slack for rounding errors
+  const double lowU = -0.5 - Tolerance;
+  const double lowV = -0.5 - Tolerance;
+  const double highU = static_cast<double>(a.width()) - 0.5 + Tolerance;
+  const double highV = static_cast<double>(a.height()) - 0.5 + Tolerance;
+
+  size_t sumX = 0;
+  size_t sumY = 0;
+  size_t count = 0;
+  size_t tested = 0;
+  for (size_t y = region.top; y < region.top + region.height; ++y) {
+    // the position of the first pixel of the row
+    double u = static_cast<double>(m[0]) * region.left + static_cast<double>(m[4]) * y + m[12];
+    double v = static_cast<double>(m[1]) * region.left + static_cast<double>(m[5]) * y + m[13];
+    std::ptrdiff_t begin = 0;
+    std::ptrdiff_t end = static_cast<std::ptrdiff_t>(region.width);
+    clip(u, m[0], lowU, highU, begin, end);
+    clip(v, m[1], lowV, highV, begin, end);
+    tested += static_cast<size_t>(std::max<std::ptrdiff_t>(end - begin, 0));
+
+    for (std::ptrdiff_t chunkBegin = begin; chunkBegin < end;
+         chunkBegin += static_cast<std::ptrdiff_t>(ChunkSize)) {
+      size_t chunkSize = std::min(ChunkSize, static_cast<size_t>(end - chunkBegin));
+      size_t x0 = region.left + static_cast<size_t>(chunkBegin);
+      sf::Uint64 solid = b.bits(static_cast<std::ptrdiff_t>(x0), y);
+      if (chunkSize < ChunkSize) {
+        solid &= (sf::Uint64(1) << chunkSize) - 1;
+      }
+      if (solid == 0) {
+        continue;
+      }
+      Chunk chunk;
+      computeChunk(u + static_cast<double>(m[0]) * chunkBegin,
+                   v + static_cast<double>(m[1]) * chunkBegin,
+                   m[0],
+                   m[1],
+                   chunkSize,
+                   chunk);
+      for (; solid != 0; solid &= solid - 1) {
+        size_t i = static_cast<size_t>(__builtin_ctzll(solid));
+        size_t x = x0 + i;
+        sf::Vector2<size_t> apos;
+        if ((chunk.inexact >> i) & 1) {
+          sf::Vector2f p = btoa.transformPoint(static_cast<float>(x), static_cast<float>(y));
+          apos = {static_cast<size_t>(std::round(p.x)), static_cast<size_t>(std::round(p.y))};
+        } else {
+          // negative positions wrap around and fail the bounds check
+          apos = {static_cast<size_t>(static_cast<std::ptrdiff_t>(chunk.x[i])),
+                  static_cast<size_t>(static_cast<std::ptrdiff_t>(chunk.y[i]))};
+        }
+        if (boundsA.contains(apos) && isSolid(a.at(apos.x, apos.y))) {
+          count += 1;
+          sumX += x;
+          sumY += y;
+        }
+      }
+    }
+  }
+  result.count += count;
+  result.sum += {static_cast<double>(sumX), static_cast<double>(sumY)};
+  result.tested += tested;
+}
+
+}
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "bitmask.hpp"
+#include "mask.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Transform.hpp>
+
+#include <cstddef>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/*! \brief Adds the overlap of a region of \p b with \p a under an arbitrary affine transformation.
+ *
+ *  Pixel \c (x,y) of \p b covers the pixel of \p a nearest to \c btoa.transformPoint(x,y),
+ *  exactly like transforming and rounding every pixel would. Instead, the region is walked row
+ *  by row: each row is clipped to the pixels mapping into \p a up front, only the solid pixels of
+ *  \p b are visited, and their positions in \p a are derived by adding constant deltas, four at
+ *  once with SSE2 or eight with AVX. Positions too close to a pixel boundary for the incremental
+ *  computation to round reliably are transformed exactly.
+ *
+ *  \param a the mask covered by \p b.
+ *  \param b the solid pixels of the covering mask.
+ *  \param btoa the transformation from \p b's to \p a's pixel coordinates.
+ *  \param region the pixels of \p b to check, must be inside of \p b.
+ *  \param result receives the number of overlapping pixels and the sum of their coordinates
+ *  in \p b's pixel coordinates, the pixels of the clipped rows count as tested.
+ */
+void addOverlap(const Mask& a, const BitMask& b, const sf::Transform& btoa,
+                const sf::Rect<size_t>& region, Overlap& result);
+
+}
+}
+}
@@ -0,0 +1,136 @@
+#include "bitmask.hpp"
+
+#include <algorithm>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+namespace {
+const size_t WordBits = 64;
+}
+
+size_t bitIndexSum(sf::Uint64 word) {
+  // bit k of the index of a set bit contributes 2^k to the sum, hence
+  // counting the set bits whose index has bit k set is sufficient
+  static const sf::Uint64 IndexBits[6] = {
+      0xAAAAAAAAAAAAAAAAULL,
+      0xCCCCCCCCCCCCCCCCULL,
+      0xF0F0F0F0F0F0F0F0ULL,
+      0xFF00FF00FF00FF00ULL,
+      0xFFFF0000FFFF0000ULL,
+      0xFFFFFFFF00000000ULL,
+  };
+  size_t sum = 0;
+  for (int k = 0; k < 6; ++k) {
+    sum += static_cast<size_t>(__builtin_popcountll(word & IndexBits[k])) << k;
+  }
+  return sum;
+}
+
+BitMask::BitMask() : m_width(0), m_height(0), m_wordsPerRow(0) {}
+
+BitMask::BitMask(const Mask& mask)
+    : m_width(mask.width()),
+      m_height(mask.height()),
+      m_wordsPerRow((mask.width() + WordBits - 1) / WordBits),
+      m_words(m_wordsPerRow * m_height, 0) {
+  update(mask, {{0, 0}, mask.size()});
+}
+
+void BitMask::update(const Mask& mask, const sf::Rect<size_t>& region) {
+  for (size_t y = region.top; y < region.top + region.height; ++y) {
+    for (size_t x = region.left; x < region.left + region.width; ++x) {
+      sf::Uint64& word = m_words[y * m_wordsPerRow + x / WordBits];
+      sf::Uint64 bit = sf::Uint64(1) << (x % WordBits);
+      if (isSolid(mask.at(x, y))) {
+        word |= bit;
+      } else {
+        word &= ~bit;
+      }
+    }
+  }
+}
+
+size_t BitMask::width() const {
+  return m_width;
+}
+
+size_t BitMask::height() const {
+  return m_height;
+}
+
+size_t BitMask::wordsPerRow() const {
+  return m_wordsPerRow;
+}
+
+bool BitMask::test(size_t x, size_t y) const {
+  return (word(x / WordBits, y) >> (x % WordBits)) & 1;
+}
+
+sf::Uint64 BitMask::word(size_t word, size_t y) const {
+  return m_words[y * m_wordsPerRow + word];
+}
+
+sf::Uint64 BitMask::wordOrZero(std::ptrdiff_t word, size_t y) const {
+  if (word < 0 || static_cast<size_t>(word) >= m_wordsPerRow) {
+    return 0;
+  }
+  return this->word(static_cast<size_t>(word), y);
+}
+
+sf::Uint64 BitMask::bits(std::ptrdiff_t x, size_t y) const {
+  const std::ptrdiff_t wordBits = static_cast<std::ptrdiff_t>(WordBits);
+  // floor division, also for negative x
+  std::ptrdiff_t word = (x >= 0 ? x : x - wordBits + 1) / wordBits;
+  unsigned shift = static_cast<unsigned>(x - word * wordBits);
+  sf::Uint64 result = wordOrZero(word, y) >> shift;
+  if (shift > 0) {
+    result |= wordOrZero(word + 1, y) << (WordBits - shift);
+  }
+  return result;
+}
+
+Overlap overlap(const BitMask& a, const BitMask& b, const sf::Vector2<std::ptrdiff_t>& offset) {
+  Overlap result;
+  // rows of b covering rows of a
+  std::ptrdiff_t firstRow = std::max<std::ptrdiff_t>(0, -offset.y);
+  std::ptrdiff_t lastRow = std::min<std::ptrdiff_t>(b.height(), a.height() - offset.y);
+  // columns of b covering columns of a
+  std::ptrdiff_t firstColumn = std::max<std::ptrdiff_t>(0, -offset.x);
+  std::ptrdiff_t lastColumn = std::min<std::ptrdiff_t>(b.width(), a.width() - offset.x);
+  if (firstRow >= lastRow || firstColumn >= lastColumn) {
+    return result;
+  }
+  const size_t firstWord = static_cast<size_t>(firstColumn) / WordBits;
+  const size_t lastWord = (static_cast<size_t>(lastColumn) + WordBits - 1) / WordBits;
+
+  size_t sumX = 0;
+  size_t sumY = 0;
+  for (std::ptrdiff_t y = firstRow; y < lastRow; ++y) {
+    size_t rowCount = 0;
+    for (size_t w = firstWord; w < lastWord; ++w) {
+      sf::Uint64 bWord = b.word(w, static_cast<size_t>(y));
+      if (bWord == 0) {
+        continue;
+      }
+      sf::Uint64 contacts =
+          bWord & a.bits(static_cast<std::ptrdiff_t>(w * WordBits) + offset.x,
+                         static_cast<size_t>(y + offset.y));
+      if (contacts != 0) {
+        size_t count = static_cast<size_t>(__builtin_popcountll(contacts));
+        rowCount += count;
+        sumX += count * w * WordBits + bitIndexSum(contacts);
+      }
+    }
+    result.count += rowCount;
+    sumY += rowCount * static_cast<size_t>(y);
+  }
+  result.sum = {static_cast<double>(sumX), static_cast<double>(sumY)};
+  result.tested = static_cast<size_t>((lastRow - firstRow) * (lastColumn - firstColumn));
+  return result;
+}
+
+}
+}
+}
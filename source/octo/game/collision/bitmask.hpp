@@ -0,0 +1,110 @@
+#pragma once
+
+#include "mask.hpp"
+
+#include <SFML/Config.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/*! \brief A bit-packed copy of the solidity of a collision \ref Mask.
+ *
+ *  Every pixel is represented by a single bit that is set if and only if the pixel is solid.
+ *  Each row is stored as a sequence of 64-bit words, where bit \c i of word \c w corresponds
+ *  to the pixel with x coordinate \c 64*w+i. Unused bits at the end of a row are always zero.
+ *
+ *  This allows testing 64 pixels at once, while the byte mask still holds the material
+ *  and destructibility of each pixel.
+ */
+class BitMask {
+public:
+  /// Initializes an empty bit mask.
+  BitMask();
+
+  /*! \brief Initializes the bit mask from the solid pixels of \p mask.
+   *  \param mask the byte mask.
+   */
+  explicit BitMask(const Mask& mask);
+
+  /*! \brief Recomputes the bits of a region from \p mask.
+   *
+   *  \param mask the byte mask this bit mask was created from.
+   *  \param region the changed pixels, must be inside of the mask.
+   */
+  void update(const Mask& mask, const sf::Rect<size_t>& region);
+
+  /// the width of the mask in pixels
+  size_t width() const;
+
+  /// the height of the mask in pixels
+  size_t height() const;
+
+  /// the number of words per row
+  size_t wordsPerRow() const;
+
+  /*! \brief Checks whether a pixel is solid.
+   */
+  bool test(size_t x, size_t y) const;
+
+  /*! \brief Returns a word of a row.
+   *  \param word the index of the word in the row, must be less than \ref wordsPerRow.
+   *  \param y the row, must be less than \ref height.
+   */
+  sf::Uint64 word(size_t word, size_t y) const;
+
+  /*! \brief Returns 64 consecutive bits of a row starting at an arbitrary pixel.
+   *
+   *  Bit \c i of the result corresponds to pixel \c x+i. Bits outside of the mask are zero.
+   *
+   *  \param x the first pixel, might be negative or beyond the width of the mask.
+   *  \param y the row, must be less than \ref height.
+   */
+  sf::Uint64 bits(std::ptrdiff_t x, size_t y) const;
+
+private:
+  /// Returns a word of a row, or zero if \p word is out of range.
+  sf::Uint64 wordOrZero(std::ptrdiff_t word, size_t y) const;
+
+  size_t m_width;
+  size_t m_height;
+  size_t m_wordsPerRow;
+  std::vector<sf::Uint64> m_words;
+};
+
+/*! \brief The result of an overlap test of two bit masks.
+ */
+struct Overlap {
+  /// the number of overlapping pixels
+  size_t count = 0;
+  /// the sum of the coordinates of all overlapping pixels
+  sf::Vector2<double> sum;
+  /// the number of pixels examined, words compared at once count all of their pixels in the region
+  size_t tested = 0;
+};
+
+/*! \brief Computes the sum of the indices of all set bits in \p word.
+ */
+size_t bitIndexSum(sf::Uint64 word);
+
+/*! \brief Computes the overlap of two bit masks that are only translated against each other.
+ *
+ *  Pixel \c (x,y) of \p b covers pixel \c (x+offset.x, y+offset.y) of \p a.
+ *  The test works on whole words, i.e. 64 pixels are compared at once.
+ *
+ *  \param a the first mask.
+ *  \param b the second mask.
+ *  \param offset the position of \p b's origin in \p a's pixel coordinates.
+ *  \returns the number of overlapping pixels and the sum of their coordinates
+ *  in \p b's pixel coordinates.
+ */
+Overlap overlap(const BitMask& a, const BitMask& b, const sf::Vector2<std::ptrdiff_t>& offset);
+
+}
+}
+}
@@ -0,0 +1,193 @@
+#include "carve.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace octo {
+namespace game {
+namespace collision {
+
+namespace {
+/// A half-open range of pixels within a row.
+struct Span {
+  std::ptrdiff_t begin;
+  std::ptrdiff_t end;
+};
+
+/// whether pixel \p x of a row is within \p circle, given the squared vertical distance \p dy2
+bool inside(const Circle& circle, float dy2, std::ptrdiff_t x) {
+  float dx = circle.center.x - static_cast<float>(x);
+  return dx * dx + dy2 <= circle.radius * circle.radius;
+}
+
+/*! \brief Computes the pixels of row \p y within \p circle, clipped to \p [0, width).
+ *  \returns \c false if the row misses the circle.
+ */
+bool circleSpan(const Circle& circle, std::ptrdiff_t y, std::ptrdiff_t width, Span& span) {
+  float dy = circle.center.y - static_cast<float>(y);
+  float dy2 = dy * dy;
+  float radiusSq = circle.radius * circle.radius;
+  if (dy2 > radiusSq) {
+    return false;
+  }
+  float half = std::sqrt(radiusSq - dy2);
+  auto first = static_cast<std::ptrdiff_t>(std::ceil(circle.center.x - half));
+  auto last = static_cast<std::ptrdiff_t>(std::floor(circle.center.x + half));
+  // the square root might be off by an ulp, the ends must agree with the per pixel test
+  while (first <= last && !inside(circle, dy2, first)) {
+    ++first;
+  }
+  while (first <= last && !inside(circle, dy2, last)) {
+    --last;
+  }
+  if (first > last) {
+    return false;
+  }
+  while (inside(circle, dy2, first - 1)) {
+    --first;
+  }
+  while (inside(circle, dy2, last + 1)) {
+    ++last;
+  }
+  span.begin = std::max<std::ptrdiff_t>(first, 0);
+  span.end = std::min(last + 1, width);
+  return span.begin < span.end;
+}
+
+/*! \brief Calls \c f(y, begin, end) for the disjoint spans of pixels within the circles, row by row.
+ */
+template <typename F>
+void forEachSpan(const Mask& mask, const std::vector<Circle>& circles, F f) {
+  const auto width = static_cast<std::ptrdiff_t>(mask.width());
+  const auto height = static_cast<std::ptrdiff_t>(mask.height());
+  if (circles.empty() || width == 0 || height == 0) {
+    return;
+  }
+  float top = circles.front().center.y - circles.front().radius;
+  float bottom = circles.front().center.y + circles.front().radius;
+  for (const Circle& circle : circles) {
+    top = std::min(top, circle.center.y - circle.radius);
+    bottom = std::max(bottom, circle.center.y + circle.radius);
+  }
+  const auto firstRow = std::max<std::ptrdiff_t>(static_cast<std::ptrdiff_t>(std::floor(top)), 0);
+  const auto lastRow =
+      std::min<std::ptrdiff_t>(static_cast<std::ptrdiff_t>(std::ceil(bottom)), height - 1);
+
+  std::vector<Span> spans;
+  spans.reserve(circles.size());
+  for (std::ptrdiff_t y = firstRow; y <= lastRow; ++y) {
+    spans.clear();
+    Span span;
+    for (const Circle& circle : circles) {
+      if (circleSpan(circle, y, width, span)) {
+        spans.push_back(span);
+      }
+    }
+    if (spans.size() > 1) {
+      std::sort(spans.begin(), spans.end(),
+                [](const Span& a, const Span& b) { return a.begin < b.begin; });
+    }
+    // merge overlapping spans, so that every pixel is visited once
+    for (size_t i = 0; i < spans.size();) {
+      Span merged = spans[i];
+      for (++i; i < spans.size() && spans[i].begin <= merged.end; ++i) {
+        merged.end = std::max(merged.end, spans[i].end);
+      }
+      f(static_cast<size_t>(y), static_cast<size_t>(merged.begin), static_cast<size_t>(merged.end));
+    }
+  }
+}
+
+/*! \brief Replaces all destructible pixels in \p [pixels, pixels+count) by Pixel::NoCollision.
+ *  \param first receives the index of the first destroyed pixel.
+ *  \param last receives the index of the last destroyed pixel.
+ *  \returns whether any pixel was destroyed.
+ */
+bool clearDestructible(Pixel* pixels, size_t count, size_t& first, size_t& last) {
+  static_assert(sizeof(Pixel) == 1, "pixels are compared bytewise");
+  static_assert(Pixel::NoCollision == Pixel(0), "pixels are cleared by masking out their bits");
+  auto* bytes = reinterpret_cast<sf::Uint8*>(pixels);
+  const auto destructible = static_cast<sf::Uint8>(Pixel::SolidDestructible);
+  bool any = false;
+  // hits holds one bit per pixel of the block starting at i
+  auto record = [&](size_t i, unsigned hits) {
+    if (!any) {
+      first = i + static_cast<size_t>(__builtin_ctz(hits));
+      any = true;
+    }
+    last = i + 31 - static_cast<size_t>(__builtin_clz(hits));
+  };
+  size_t i = 0;
+#if defined(__AVX2__)
+  const __m256i destructible32 = _mm256_set1_epi8(static_cast<char>(destructible));
+  for (; i + 32 <= count; i += 32) {
+    auto* p = reinterpret_cast<__m256i*>(bytes + i);
+    __m256i value = _mm256_loadu_si256(p);
+    __m256i hit = _mm256_cmpeq_epi8(value, destructible32);
+    auto hits = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+    if (hits != 0) {
+      _mm256_storeu_si256(p, _mm256_andnot_si256(hit, value));
+      record(i, hits);
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i destructible16 = _mm_set1_epi8(static_cast<char>(destructible));
+  for (; i + 16 <= count; i += 16) {
+    auto* p = reinterpret_cast<__m128i*>(bytes + i);
+    __m128i value = _mm_loadu_si128(p);
+    __m128i hit = _mm_cmpeq_epi8(value, destructible16);
+    auto hits = static_cast<unsigned>(_mm_movemask_epi8(hit));
+    if (hits != 0) {
+      _mm_storeu_si128(p, _mm_andnot_si128(hit, value));
+      record(i, hits);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    if (bytes[i] == destructible) {
+      bytes[i] = 0;
+      record(i, 1);
+    }
+  }
+  return any;
+}
+}
+
+sf::Rect<size_t> carve(Mask& mask, const std::vector<Circle>& circles) {
+  size_t left = mask.width();
+  size_t top = mask.height();
+  size_t right = 0;
+  size_t bottom = 0;
+  forEachSpan(mask, circles, [&](size_t y, size_t begin, size_t end) {
+    size_t first;
+    size_t last;
+    if (clearDestructible(&mask.at(begin, y), end - begin, first, last)) {
+      left = std::min(left, begin + first);
+      right = std::max(right, begin + last + 1);
+      top = std::min(top, y);
+      bottom = y + 1;
+    }
+  });
+  if (left >= right) {
+    return {};
+  }
+  return {left, top, right - left, bottom - top};
+}
+
+bool canCarve(const Mask& mask, const std::vector<Circle>& circles) {
+  bool any = false;
+  forEachSpan(mask, circles, [&](size_t y, size_t begin, size_t end) {
+    for (size_t x = begin; x < end && !any; ++x) {
+      any = isDestructible(mask.at(x, y));
+    }
+  });
+  return any;
+}
+
+}
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "mask.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/// A circle in the pixel coordinates of a mask.
+struct Circle {
+  sf::Vector2f center;
+  float radius;
+};
+
+/*! \brief Destroys all destructible pixels within any of the circles.
+ *
+ *  Pixel \c p is within a circle if the squared distance between \c p and its center is at
+ *  most the squared radius. Instead of testing every pixel of the bounding boxes, the exact span
+ *  covered by the circles is computed for each row, and only the pixels within the spans are
+ *  compared and cleared, many at once when compiling for SSE2 or AVX2. Overlapping circles
+ *  are processed in a single pass.
+ *
+ *  \param mask the mask to modify.
+ *  \param circles the circles, possibly exceeding the mask.
+ *  \returns the bounding box of the destroyed pixels, empty if none was destroyed.
+ */
+sf::Rect<size_t> carve(Mask& mask, const std::vector<Circle>& circles);
+
+/*! \brief Checks whether \ref carve would destroy any pixel, without modifying the mask.
+ *
+ *  This allows leaving shared masks untouched if they are not affected.
+ */
+bool canCarve(const Mask& mask, const std::vector<Circle>& circles);
+
+}
+}
+}
@@ -0,0 +1,182 @@
+#include "distancefield.hpp"
+
+#include <octo/math/vector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+namespace {
+
+const float Infinity = std::numeric_limits<float>::infinity();
+
+/*! \brief One dimensional squared Euclidean distance transform.
+ *
+ *  Computes the lower envelope of parabolas rooted at each sample, see
+ *  Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled Functions".
+ *
+ *  \param f the input samples, replaced with the transformed values.
+ *  \param n the number of samples.
+ *  \param stride the distance between two consecutive samples in \p f.
+ *  \param v scratch space for at least \p n parabola locations.
+ *  \param z scratch space for at least \p n+1 parabola boundaries.
+ *  \param d scratch space for at least \p n results.
+ */
+void transform1d(float* f, size_t n, size_t stride, std::vector<int>& v, std::vector<float>& z,
+                 std::vector<float>& d) {
+  // samples at infinity never contribute to the envelope
+  size_t first = 0;
+  while (first < n && f[first * stride] == Infinity) {
+    first += 1;
+  }
+  if (first == n) {
+    return;
+  }
+  // intersection of the parabolas rooted at q and p
+  auto intersect = [f, stride](int q, int p) {
+    return ((f[q * stride] + q * q) - (f[p * stride] + p * p)) / (2.f * (q - p));
+  };
+
+  size_t k = 0;
+  v[0] = static_cast<int>(first);
+  z[0] = -Infinity;
+  z[1] = Infinity;
+  for (size_t q = first + 1; q < n; ++q) {
+    if (f[q * stride] == Infinity) {
+      continue;
+    }
+    float s = intersect(static_cast<int>(q), v[k]);
+    while (s <= z[k]) {
+      k -= 1;
+      s = intersect(static_cast<int>(q), v[k]);
+    }
+    k += 1;
+    v[k] = static_cast<int>(q);
+    z[k] = s;
+    z[k + 1] = Infinity;
+  }
+  k = 0;
+  for (size_t q = 0; q < n; ++q) {
+    while (z[k + 1] < q) {
+      k += 1;
+    }
+    float delta = static_cast<float>(q) - v[k];
+    d[q] = delta * delta + f[v[k] * stride];
+  }
+  for (size_t q = 0; q < n; ++q) {
+    f[q * stride] = d[q];
+  }
+}
+
+/*! \brief Two dimensional squared Euclidean distance transform, applied in place.
+ */
+void transform2d(std::vector<float>& grid, size_t width, size_t height) {
+  size_t n = std::max(width, height);
+  std::vector<int> v(n);
+  std::vector<float> z(n + 1);
+  std::vector<float> d(n);
+  for (size_t x = 0; x < width; ++x) {
+    transform1d(&grid[x], height, width, v, z, d);
+  }
+  for (size_t y = 0; y < height; ++y) {
+    transform1d(&grid[y * width], width, 1, v, z, d);
+  }
+}
+}
+
+DistanceField::DistanceField(const Mask& mask, float maxDistance)
+    : m_maxDistance(maxDistance),
+      m_width(mask.width()),
+      m_height(mask.height()),
+      m_distances(mask.width() * mask.height(), maxDistance) {
+  compute(mask, {{0, 0}, mask.size()});
+}
+
+void DistanceField::update(const Mask& mask, const sf::Rect<size_t>& region) {
+  // every pixel within the maximum distance might have changed
+  size_t margin = static_cast<size_t>(std::ceil(m_maxDistance)) + 1;
+  size_t left = region.left > margin ? region.left - margin : 0;
+  size_t top = region.top > margin ? region.top - margin : 0;
+  size_t right = std::min(m_width, region.left + region.width + margin);
+  size_t bottom = std::min(m_height, region.top + region.height + margin);
+  if (left < right && top < bottom) {
+    compute(mask, {{left, top}, {right - left, bottom - top}});
+  }
+}
+
+float DistanceField::maxDistance() const {
+  return m_maxDistance;
+}
+
+float DistanceField::at(size_t x, size_t y) const {
+  return m_distances[y * m_width + x];
+}
+
+float DistanceField::clampedAt(std::ptrdiff_t x, std::ptrdiff_t y) const {
+  if (x < 0 || y < 0 || x >= static_cast<std::ptrdiff_t>(m_width) ||
+      y >= static_cast<std::ptrdiff_t>(m_height)) {
+    return m_maxDistance;
+  }
+  return at(static_cast<size_t>(x), static_cast<size_t>(y));
+}
+
+sf::Vector2f DistanceField::normal(size_t x, size_t y) const {
+  // Sobel operator for a smoother gradient
+  std::ptrdiff_t px = static_cast<std::ptrdiff_t>(x);
+  std::ptrdiff_t py = static_cast<std::ptrdiff_t>(y);
+  auto d = [&](int dx, int dy) { return clampedAt(px + dx, py + dy); };
+  sf::Vector2f gradient{
+      (d(1, -1) + 2 * d(1, 0) + d(1, 1)) - (d(-1, -1) + 2 * d(-1, 0) + d(-1, 1)),
+      (d(-1, 1) + 2 * d(0, 1) + d(1, 1)) - (d(-1, -1) + 2 * d(0, -1) + d(1, -1)),
+  };
+  if (gradient.x != 0 || gradient.y != 0) {
+    return math::vector::normalized(gradient);
+  } else {
+    return {0, 0};
+  }
+}
+
+void DistanceField::compute(const Mask& mask, const sf::Rect<size_t>& region) {
+  // the pixels within the maximum distance around the region determine its distances
+  const std::ptrdiff_t margin = static_cast<std::ptrdiff_t>(std::ceil(m_maxDistance)) + 1;
+  const std::ptrdiff_t left = static_cast<std::ptrdiff_t>(region.left) - margin;
+  const std::ptrdiff_t top = static_cast<std::ptrdiff_t>(region.top) - margin;
+  const size_t width = region.width + 2 * margin;
+  const size_t height = region.height + 2 * margin;
+
+  // squared distances to the nearest solid resp. empty pixel
+  std::vector<float> toSolid(width * height);
+  std::vector<float> toEmpty(width * height);
+  for (size_t wy = 0; wy < height; ++wy) {
+    for (size_t wx = 0; wx < width; ++wx) {
+      std::ptrdiff_t x = left + static_cast<std::ptrdiff_t>(wx);
+      std::ptrdiff_t y = top + static_cast<std::ptrdiff_t>(wy);
+      // pixels outside of the mask are empty
+      bool solid = x >= 0 && y >= 0 && x < static_cast<std::ptrdiff_t>(m_width) &&
+                   y < static_cast<std::ptrdiff_t>(m_height) &&
+                   isSolid(mask.at(static_cast<size_t>(x), static_cast<size_t>(y)));
+      toSolid[wy * width + wx] = solid ? 0 : Infinity;
+      toEmpty[wy * width + wx] = solid ? Infinity : 0;
+    }
+  }
+  transform2d(toSolid, width, height);
+  transform2d(toEmpty, width, height);
+
+  for (size_t y = region.top; y < region.top + region.height; ++y) {
+    for (size_t x = region.left; x < region.left + region.width; ++x) {
+      size_t index = (y - top) * width + (x - left);
+      // the boundary lies half a pixel between a solid and an empty pixel
+      float distance = toSolid[index] > 0 ? std::sqrt(toSolid[index]) - 0.5f
+                                          : 0.5f - std::sqrt(toEmpty[index]);
+      m_distances[y * m_width + x] = std::max(-m_maxDistance, std::min(m_maxDistance, distance));
+    }
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "mask.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/*! \brief A truncated signed distance field of the solid pixels of a collision \ref Mask.
+ *
+ *  Every pixel stores the Euclidean distance to the boundary of the solid region,
+ *  negative inside and positive outside of it. Pixels outside of the mask count as empty.
+ *  Distances are clamped to \f$ [-d_{max}, d_{max}] \f$, which means that changes of the mask
+ *  only affect the field within \f$ d_{max} \f$ of the changed pixels.
+ *
+ *  The gradient of the field points away from the solid region, hence it can be used
+ *  as surface normal that is available in constant time.
+ */
+class DistanceField {
+public:
+  /*! \brief Computes the distance field of a mask.
+   *  \param mask the collision mask.
+   *  \param maxDistance the distance at which the field is truncated.
+   */
+  DistanceField(const Mask& mask, float maxDistance);
+
+  /*! \brief Recomputes the field after pixels of the mask have changed.
+   *
+   *  Only the pixels within the maximum distance of \p region are recomputed.
+   *
+   *  \param mask the mask this field was created from.
+   *  \param region the changed pixels.
+   */
+  void update(const Mask& mask, const sf::Rect<size_t>& region);
+
+  /// the distance at which the field is truncated
+  float maxDistance() const;
+
+  /*! \brief The signed distance of a pixel to the boundary.
+   */
+  float at(size_t x, size_t y) const;
+
+  /*! \brief Computes the surface normal at a pixel from the gradient of the field.
+   *
+   *  \param x the x coordinate of the pixel, must be inside of the mask.
+   *  \param y the y coordinate of the pixel, must be inside of the mask.
+   *  \returns the normalized gradient at \c (x,y), or a zero vector
+   *  if the field is constant around that pixel.
+   */
+  sf::Vector2f normal(size_t x, size_t y) const;
+
+private:
+  /*! \brief Computes the field for all pixels in \p region.
+   *  \param mask the collision mask.
+   *  \param region the pixels to recompute, must be inside of the mask.
+   */
+  void compute(const Mask& mask, const sf::Rect<size_t>& region);
+
+  /// Clamped read access, pixels outside of the mask are treated as far away from any surface.
+  float clampedAt(std::ptrdiff_t x, std::ptrdiff_t y) const;
+
+  float m_maxDistance;
+  size_t m_width;
+  size_t m_height;
+  std::vector<float> m_distances;
+};
+
+}
+}
+}
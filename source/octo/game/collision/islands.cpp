@@ -0,0 +1,115 @@
+#include "islands.hpp"
+
+#include <algorithm>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+namespace {
+/// marks pixels of the window that have not been reached by any fill yet
+const size_t Unvisited = static_cast<size_t>(-1);
+}
+
+std::vector<Island> findDetachedIslands(const Mask& mask, const sf::Rect<size_t>& region,
+                                        size_t margin) {
+  std::vector<Island> islands;
+  if (region.width == 0 || region.height == 0 || mask.width() == 0 || mask.height() == 0) {
+    return islands;
+  }
+  // the pixels which are flood filled, and the pixels next to the region seeding the fills
+  auto extend = [&](size_t distance) {
+    size_t left = region.left - std::min(region.left, distance);
+    size_t top = region.top - std::min(region.top, distance);
+    size_t right = std::min(region.left + region.width + distance, mask.width());
+    size_t bottom = std::min(region.top + region.height + distance, mask.height());
+    return sf::Rect<size_t>(left, top, right - left, bottom - top);
+  };
+  const sf::Rect<size_t> window = extend(margin);
+  const sf::Rect<size_t> seeds = extend(1);
+  const size_t windowRight = window.left + window.width;
+  const size_t windowBottom = window.top + window.height;
+  // whether a pixel at the border of the window has neighbours outside of it
+  const bool openLeft = window.left > 0;
+  const bool openTop = window.top > 0;
+  const bool openRight = windowRight < mask.width();
+  const bool openBottom = windowBottom < mask.height();
+
+  // the island index of every pixel within the window
+  std::vector<size_t> labels(window.width * window.height, Unvisited);
+  auto label = [&](size_t x, size_t y) -> size_t& {
+    return labels[(y - window.top) * window.width + (x - window.left)];
+  };
+
+  std::vector<size_t> stack;
+  // the pieces reaching the border of the window are attached
+  std::vector<bool> attached;
+  for (size_t sy = seeds.top; sy < seeds.top + seeds.height; ++sy) {
+    for (size_t sx = seeds.left; sx < seeds.left + seeds.width; ++sx) {
+      if (!isSolid(mask.at(sx, sy)) || label(sx, sy) != Unvisited) {
+        continue;
+      }
+      const size_t index = islands.size();
+      islands.emplace_back();
+      Island& island = islands.back();
+      bool reachesBorder = false;
+      size_t left = sx;
+      size_t top = sy;
+      size_t right = sx;
+      size_t bottom = sy;
+      label(sx, sy) = index;
+      stack.push_back(sy * mask.width() + sx);
+      while (!stack.empty()) {
+        size_t pixel = stack.back();
+        stack.pop_back();
+        island.pixels.push_back(pixel);
+        size_t x = pixel % mask.width();
+        size_t y = pixel / mask.width();
+        left = std::min(left, x);
+        right = std::max(right, x);
+        top = std::min(top, y);
+        bottom = std::max(bottom, y);
+        reachesBorder = reachesBorder || (openLeft && x == window.left) ||
+                        (openTop && y == window.top) || (openRight && x + 1 == windowRight) ||
+                        (openBottom && y + 1 == windowBottom);
+        for (size_t ny = std::max(y, window.top + 1) - 1; ny <= std::min(y + 1, windowBottom - 1);
+             ++ny) {
+          for (size_t nx = std::max(x, window.left + 1) - 1;
+               nx <= std::min(x + 1, windowRight - 1);
+               ++nx) {
+            if (isSolid(mask.at(nx, ny)) && label(nx, ny) == Unvisited) {
+              label(nx, ny) = index;
+              stack.push_back(ny * mask.width() + nx);
+            }
+          }
+        }
+      }
+      island.bounds = {left, top, right - left + 1, bottom - top + 1};
+      attached.push_back(reachesBorder);
+    }
+  }
+
+  if (std::find(attached.begin(), attached.end(), true) == attached.end() && !islands.empty()) {
+    // the main body lies entirely within the window
+    auto largest = std::max_element(islands.begin(), islands.end(),
+                                    [](const Island& a, const Island& b) {
+                                      return a.pixels.size() < b.pixels.size();
+                                    });
+    attached[static_cast<size_t>(largest - islands.begin())] = true;
+  }
+  size_t detached = 0;
+  for (size_t i = 0; i < islands.size(); ++i) {
+    if (!attached[i]) {
+      if (detached != i) {
+        islands[detached] = std::move(islands[i]);
+      }
+      ++detached;
+    }
+  }
+  islands.resize(detached);
+  return islands;
+}
+
+}
+}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "mask.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/// A piece of a mask whose solid pixels are connected to each other, but not to the rest.
+struct Island {
+  /// the pixels of the piece, as indices \c y*width+x into the mask
+  std::vector<size_t> pixels;
+  /// the bounding box of \ref pixels
+  sf::Rect<size_t> bounds;
+};
+
+/*! \brief Finds the pieces of a mask that got disconnected by removing pixels within a region.
+ *
+ *  Removing pixels can only split the shapes touching the removed pixels, hence only the solid
+ *  pixels in and around \p region are flood filled, with two pixels being connected if they
+ *  touch at an edge or a corner. The fill is limited to \p region extended by \p margin pixels
+ *  in every direction. A piece reaching the limit is considered to be connected to the main
+ *  body of the mask outside of it, hence detached pieces larger than the limit are missed.
+ *  If no piece reaches the limit, e.g. because it covers the whole mask, the largest piece
+ *  is the main body.
+ *
+ *  \param mask the mask, already modified.
+ *  \param region the removed pixels.
+ *  \param margin the distance around \p region within which detached pieces are found.
+ *  \returns all pieces except for the main body.
+ */
+std::vector<Island> findDetachedIslands(const Mask& mask, const sf::Rect<size_t>& region,
+                                        size_t margin);
+
+}
+}
+}
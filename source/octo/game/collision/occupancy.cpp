@@ -0,0 +1,280 @@
+#include "occupancy.hpp"
+
+namespace octo {
+namespace game {
+namespace collision {
+
+namespace {
+const size_t WordBits = 64;
+
+/// the binary logarithm of OccupancyPyramid::BlockSize
+const unsigned BlockShift = 4;
+
+static_assert(WordBits % OccupancyPyramid::BlockSize == 0,
+              "a block of level 0 must not span several words");
+static_assert(OccupancyPyramid::BlockSize == 1u << BlockShift, "BlockShift must match BlockSize");
+
+/// a word with the lowest \p count bits set
+sf::Uint64 lowBits(size_t count) {
+  return count >= WordBits ? ~sf::Uint64(0) : (sf::Uint64(1) << count) - 1;
+}
+
+/*! \brief Adds the pixels of a region of \p b which are solid in \p b and \p a to \p result.
+ *
+ *  If \p a is null, all of its pixels are considered solid.
+ *
+ *  \param region the pixels of \p b, \p offset must map them into \p a.
+ */
+void overlapRegion(const BitMask* a, const BitMask& b, const sf::Vector2<std::ptrdiff_t>& offset,
+                   const sf::Rect<size_t>& region, Overlap& result) {
+  const size_t right = region.left + region.width;
+  const size_t firstWord = region.left / WordBits;
+  const size_t lastWord = (right + WordBits - 1) / WordBits;
+  // the columns of the region within the first and last word
+  const sf::Uint64 firstColumns = ~lowBits(region.left % WordBits);
+  const sf::Uint64 lastColumns = lowBits(right - (lastWord - 1) * WordBits);
+  size_t sumX = 0;
+  size_t sumY = 0;
+  size_t count = 0;
+  for (size_t y = region.top; y < region.top + region.height; ++y) {
+    size_t rowCount = 0;
+    for (size_t w = firstWord; w < lastWord; ++w) {
+      sf::Uint64 contacts = b.word(w, y);
+      if (w == firstWord) {
+        contacts &= firstColumns;
+      }
+      if (w == lastWord - 1) {
+        contacts &= lastColumns;
+      }
+      if (contacts != 0 && a) {
+        contacts &= a->bits(static_cast<std::ptrdiff_t>(w * WordBits) + offset.x,
+                            static_cast<size_t>(static_cast<std::ptrdiff_t>(y) + offset.y));
+      }
+      if (contacts != 0) {
+        size_t wordCount = static_cast<size_t>(__builtin_popcountll(contacts));
+        rowCount += wordCount;
+        sumX += wordCount * w * WordBits + bitIndexSum(contacts);
+      }
+    }
+    count += rowCount;
+    sumY += rowCount * y;
+  }
+  result.count += count;
+  result.sum += {static_cast<double>(sumX), static_cast<double>(sumY)};
+  result.tested += region.width * region.height;
+}
+}
+
+constexpr size_t OccupancyPyramid::BlockSize;
+
+OccupancyPyramid::OccupancyPyramid() : m_width(0), m_height(0) {}
+
+OccupancyPyramid::OccupancyPyramid(const BitMask& bits)
+    : m_width(bits.width()), m_height(bits.height()) {
+  if (m_width == 0 || m_height == 0) {
+    return;
+  }
+  size_t width = (m_width + BlockSize - 1) / BlockSize;
+  size_t height = (m_height + BlockSize - 1) / BlockSize;
+  while (true) {
+    m_levels.push_back({width, height, std::vector<Occupancy>(width * height, Occupancy::Mixed)});
+    if (width == 1 && height == 1) {
+      break;
+    }
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+  }
+  update(bits, {{0, 0}, {m_width, m_height}});
+}
+
+void OccupancyPyramid::update(const BitMask& bits, const sf::Rect<size_t>& region) {
+  if (m_levels.empty() || region.width == 0 || region.height == 0) {
+    return;
+  }
+  // the range of affected blocks, inclusive
+  size_t x0 = region.left / BlockSize;
+  size_t y0 = region.top / BlockSize;
+  size_t x1 = (region.left + region.width - 1) / BlockSize;
+  size_t y1 = (region.top + region.height - 1) / BlockSize;
+  for (size_t y = y0; y <= y1; ++y) {
+    for (size_t x = x0; x <= x1; ++x) {
+      m_levels[0].blocks[y * m_levels[0].width + x] = leaf(bits, x, y);
+    }
+  }
+  // only the ancestors of the affected blocks change
+  for (size_t level = 1; level < m_levels.size(); ++level) {
+    x0 /= 2;
+    y0 /= 2;
+    x1 /= 2;
+    y1 /= 2;
+    Level& current = m_levels[level];
+    for (size_t y = y0; y <= y1; ++y) {
+      for (size_t x = x0; x <= x1; ++x) {
+        current.blocks[y * current.width + x] = combine(level, x, y);
+      }
+    }
+  }
+}
+
+size_t OccupancyPyramid::levels() const {
+  return m_levels.size();
+}
+
+Occupancy OccupancyPyramid::block(size_t level, size_t x, size_t y) const {
+  const Level& l = m_levels[level];
+  return l.blocks[y * l.width + x];
+}
+
+Occupancy OccupancyPyramid::region(const sf::Rect<std::ptrdiff_t>& region) const {
+  // clip the region to the mask, the pixels outside are empty
+  std::ptrdiff_t left = std::max<std::ptrdiff_t>(region.left, 0);
+  std::ptrdiff_t top = std::max<std::ptrdiff_t>(region.top, 0);
+  std::ptrdiff_t right = std::min<std::ptrdiff_t>(region.left + region.width, m_width);
+  std::ptrdiff_t bottom = std::min<std::ptrdiff_t>(region.top + region.height, m_height);
+  if (left >= right || top >= bottom) {
+    return Occupancy::Empty;
+  }
+  // on the finest level whose blocks are at least as large as the region,
+  // the region touches at most two by two blocks
+  size_t extent = static_cast<size_t>(std::max(right - left, bottom - top));
+  size_t level = 0;
+  while ((BlockSize << level) < extent && level + 1 < m_levels.size()) {
+    ++level;
+  }
+  const Level& l = m_levels[level];
+  const unsigned shift = BlockShift + static_cast<unsigned>(level);
+  bool any = false;
+  bool all = true;
+  for (size_t y = static_cast<size_t>(top) >> shift; y <= static_cast<size_t>(bottom - 1) >> shift;
+       ++y) {
+    for (size_t x = static_cast<size_t>(left) >> shift; x <= static_cast<size_t>(right - 1) >> shift;
+         ++x) {
+      Occupancy occupancy = l.blocks[y * l.width + x];
+      if (occupancy == Occupancy::Mixed) {
+        return Occupancy::Mixed;
+      }
+      any = any || occupancy == Occupancy::Full;
+      all = all && occupancy == Occupancy::Full;
+    }
+  }
+  if (!any) {
+    return Occupancy::Empty;
+  }
+  bool inside = left == region.left && top == region.top &&
+                right == region.left + region.width && bottom == region.top + region.height;
+  return all && inside ? Occupancy::Full : Occupancy::Mixed;
+}
+
+Occupancy OccupancyPyramid::leaf(const BitMask& bits, size_t x, size_t y) const {
+  sf::Rect<size_t> rect = blockRect(0, x, y);
+  const size_t word = rect.left / WordBits;
+  const size_t shift = rect.left % WordBits;
+  const sf::Uint64 columns = lowBits(rect.width);
+  bool any = false;
+  bool all = true;
+  for (size_t row = rect.top; row < rect.top + rect.height; ++row) {
+    sf::Uint64 solid = (bits.word(word, row) >> shift) & columns;
+    any = any || solid != 0;
+    all = all && solid == columns;
+    if (any && !all) {
+      return Occupancy::Mixed;
+    }
+  }
+  return any ? Occupancy::Full : Occupancy::Empty;
+}
+
+Occupancy OccupancyPyramid::combine(size_t level, size_t x, size_t y) const {
+  const Level& children = m_levels[level - 1];
+  bool any = false;
+  bool all = true;
+  for (size_t cy = 2 * y; cy < std::min(2 * y + 2, children.height); ++cy) {
+    for (size_t cx = 2 * x; cx < std::min(2 * x + 2, children.width); ++cx) {
+      Occupancy child = children.blocks[cy * children.width + cx];
+      if (child == Occupancy::Mixed) {
+        return Occupancy::Mixed;
+      }
+      any = any || child == Occupancy::Full;
+      all = all && child == Occupancy::Full;
+    }
+  }
+  return all ? Occupancy::Full : any ? Occupancy::Mixed : Occupancy::Empty;
+}
+
+sf::Rect<size_t> OccupancyPyramid::blockRect(size_t level, size_t x, size_t y) const {
+  size_t size = BlockSize << level;
+  size_t left = x * size;
+  size_t top = y * size;
+  return {left, top, std::min(size, m_width - left), std::min(size, m_height - top)};
+}
+
+Overlap overlap(const BitMask& a, const OccupancyPyramid& occupancyA, const BitMask& b,
+                const OccupancyPyramid& occupancyB, const sf::Vector2<std::ptrdiff_t>& offset) {
+  Overlap result;
+  // rows and columns of b covering a
+  std::ptrdiff_t firstRow = std::max<std::ptrdiff_t>(0, -offset.y);
+  std::ptrdiff_t lastRow = std::min<std::ptrdiff_t>(b.height(), a.height() - offset.y);
+  std::ptrdiff_t firstColumn = std::max<std::ptrdiff_t>(0, -offset.x);
+  std::ptrdiff_t lastColumn = std::min<std::ptrdiff_t>(b.width(), a.width() - offset.x);
+  if (firstRow >= lastRow || firstColumn >= lastColumn) {
+    return result;
+  }
+  sf::Rect<size_t> region(static_cast<size_t>(firstColumn),
+                          static_cast<size_t>(firstRow),
+                          static_cast<size_t>(lastColumn - firstColumn),
+                          static_cast<size_t>(lastRow - firstRow));
+  occupancyB.descend(region, [&](const sf::Rect<size_t>& rect, Occupancy occupancy, bool leaf) {
+    Occupancy other = occupancyA.region({static_cast<std::ptrdiff_t>(rect.left) + offset.x,
+                                         static_cast<std::ptrdiff_t>(rect.top) + offset.y,
+                                         static_cast<std::ptrdiff_t>(rect.width),
+                                         static_cast<std::ptrdiff_t>(rect.height)});
+    if (other == Occupancy::Empty) {
+      return false;
+    }
+    if (other == Occupancy::Full) {
+      // every solid pixel of b overlaps
+      if (occupancy == Occupancy::Full) {
+        addRect(result, rect);
+      } else {
+        overlapRegion(nullptr, b, offset, rect, result);
+      }
+      return false;
+    }
+    if (occupancy == Occupancy::Full) {
+      // every solid pixel of a overlaps, count them in a's coordinates
+      Overlap inA;
+      overlapRegion(nullptr,
+                    a,
+                    {0, 0},
+                    {static_cast<size_t>(static_cast<std::ptrdiff_t>(rect.left) + offset.x),
+                     static_cast<size_t>(static_cast<std::ptrdiff_t>(rect.top) + offset.y),
+                     rect.width,
+                     rect.height},
+                    inA);
+      result.count += inA.count;
+      result.tested += inA.tested;
+      result.sum += inA.sum - static_cast<double>(inA.count) *
+                                  sf::Vector2<double>(static_cast<double>(offset.x),
+                                                      static_cast<double>(offset.y));
+      return false;
+    }
+    // below the width of a word, finer blocks hardly save any work
+    if (!leaf && rect.width > WordBits) {
+      return true;
+    }
+    overlapRegion(&a, b, offset, rect, result);
+    return false;
+  });
+  return result;
+}
+
+void addRect(Overlap& overlap, const sf::Rect<size_t>& rect) {
+  // sums of the consecutive coordinates in every row and column
+  size_t sumX = (2 * rect.left + rect.width - 1) * rect.width / 2;
+  size_t sumY = (2 * rect.top + rect.height - 1) * rect.height / 2;
+  overlap.count += rect.width * rect.height;
+  overlap.sum += {static_cast<double>(sumX * rect.height), static_cast<double>(sumY * rect.width)};
+}
+
+}
+}
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "bitmask.hpp"
+
+#include <SFML/Config.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/// Describes the solid pixels within a block of a mask.
+enum class Occupancy : sf::Uint8 {
+  /// no pixel is solid
+  Empty,
+  /// every pixel is solid
+  Full,
+  /// some pixels are solid, or it is unknown whether all or none of them are
+  Mixed,
+};
+
+/*! \brief A mip-map like hierarchy describing which blocks of a BitMask are empty or full.
+ *
+ *  Level 0 divides the mask into square blocks of \ref BlockSize pixels, every following level
+ *  combines two by two blocks of the previous one, up to a single block covering the whole mask.
+ *  Large masks like planets are mostly solid or empty, hence overlap tests can skip or accept
+ *  whole blocks and only need to look at pixels near the surface.
+ */
+class OccupancyPyramid {
+public:
+  /// The edge length of the blocks of level 0 in pixels, a divisor of the bits per word.
+  static constexpr size_t BlockSize = 16;
+
+  /// Initializes an empty pyramid.
+  OccupancyPyramid();
+
+  /*! \brief Initializes the pyramid from the solid pixels of \p bits.
+   */
+  explicit OccupancyPyramid(const BitMask& bits);
+
+  /*! \brief Recomputes the blocks containing a region and their ancestors.
+   *
+   *  \param bits the bit mask this pyramid was created from, already updated.
+   *  \param region the changed pixels, must be inside of the mask.
+   */
+  void update(const BitMask& bits, const sf::Rect<size_t>& region);
+
+  /// the number of levels, zero for an empty mask
+  size_t levels() const;
+
+  /// the occupancy of a block, \p x and \p y are block coordinates on \p level
+  Occupancy block(size_t level, size_t x, size_t y) const;
+
+  /*! \brief Determines the occupancy of an arbitrary region.
+   *
+   *  Pixels outside of the mask count as empty. The region is only compared against the blocks
+   *  of the finest level that are at least as large as the region itself, which takes constant
+   *  time. Hence the result might be \ref Occupancy::Mixed even though all pixels within
+   *  the region are empty or full.
+   *
+   *  \param region the region in pixel coordinates, might exceed the mask.
+   */
+  Occupancy region(const sf::Rect<std::ptrdiff_t>& region) const;
+
+  /*! \brief Visits the non-empty blocks intersecting a region from coarse to fine.
+   *
+   *  The visitor is called as \c visit(rect, occupancy, leaf), where \c rect is the block
+   *  clipped to \p region, and \c leaf is \c true for blocks of level 0. If it returns \c true
+   *  for a block that is not a leaf, the children of the block are visited instead.
+   *
+   *  \param region the region in pixel coordinates, must be inside of the mask.
+   *  \param visit the visitor.
+   */
+  template <typename F>
+  void descend(const sf::Rect<size_t>& region, F visit) const;
+
+private:
+  struct Level {
+    size_t width;
+    size_t height;
+    std::vector<Occupancy> blocks;
+  };
+
+  /// Computes a block of level 0 from the bits.
+  Occupancy leaf(const BitMask& bits, size_t x, size_t y) const;
+
+  /// Combines the up to four children of a block on a level above 0.
+  Occupancy combine(size_t level, size_t x, size_t y) const;
+
+  /// the pixels covered by a block
+  sf::Rect<size_t> blockRect(size_t level, size_t x, size_t y) const;
+
+  template <typename F>
+  void descend(size_t level, size_t x, size_t y, const sf::Rect<size_t>& region, F& visit) const;
+
+  size_t m_width;
+  size_t m_height;
+  /// the levels from the finest to the coarsest
+  std::vector<Level> m_levels;
+};
+
+/*! \brief Computes the overlap of two bit masks that are only translated against each other.
+ *
+ *  Gives the same result as overlap(const BitMask&, const BitMask&, const sf::Vector2<std::ptrdiff_t>&),
+ *  but descends the occupancy pyramids of both masks: blocks which are empty in either mask are
+ *  skipped and full blocks covering full regions are counted without looking at their pixels.
+ *
+ *  \param a the first mask.
+ *  \param occupancyA the occupancy pyramid of \p a.
+ *  \param b the second mask.
+ *  \param occupancyB the occupancy pyramid of \p b.
+ *  \param offset the position of \p b's origin in \p a's pixel coordinates.
+ */
+Overlap overlap(const BitMask& a, const OccupancyPyramid& occupancyA, const BitMask& b,
+                const OccupancyPyramid& occupancyB, const sf::Vector2<std::ptrdiff_t>& offset);
+
+/*! \brief Adds all pixels of a rectangle to an overlap.
+ */
+void addRect(Overlap& overlap, const sf::Rect<size_t>& rect);
+
+template <typename F>
+void OccupancyPyramid::descend(const sf::Rect<size_t>& region, F visit) const {
+  if (!m_levels.empty()) {
+    descend(m_levels.size() - 1, 0, 0, region, visit);
+  }
+}
+
+template <typename F>
+void OccupancyPyramid::descend(size_t level, size_t x, size_t y, const sf::Rect<size_t>& region,
+                               F& visit) const {
+  Occupancy occupancy = block(level, x, y);
+  sf::Rect<size_t> rect;
+  if (occupancy == Occupancy::Empty || !blockRect(level, x, y).intersects(region, rect)) {
+    return;
+  }
+  bool leaf = level == 0;
+  if (visit(rect, occupancy, leaf) && !leaf) {
+    const Level& children = m_levels[level - 1];
+    for (size_t cy = 2 * y; cy < std::min(2 * y + 2, children.height); ++cy) {
+      for (size_t cx = 2 * x; cx < std::min(2 * x + 2, children.width); ++cx) {
+        descend(level - 1, cx, cy, region, visit);
+      }
+    }
+  }
+}
+
+}
+}
+}
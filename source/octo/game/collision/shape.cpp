@@ -0,0 +1,51 @@
+#include "shape.hpp"
+
+namespace octo {
+namespace game {
+namespace collision {
+
+Shape::Shape(Mask mask) : mask(std::move(mask)), solidity(this->mask), occupancy(solidity) {}
+
+Shape::Shape(const Shape& other)
+    : mask(other.mask.clone()), solidity(other.solidity), occupancy(other.occupancy) {}
+
+void Shape::update(const sf::Rect<size_t>& region) {
+  solidity.update(mask, region);
+  occupancy.update(solidity, region);
+}
+
+std::shared_ptr<const Shape> ShapeCache::circle(size_t radius, Pixel fill) {
+  return get(Key{Kind::Circle, radius, radius, fill},
+             [&] { return collision::circle(radius, fill); });
+}
+
+std::shared_ptr<const Shape> ShapeCache::ellipse(size_t width, size_t height, Pixel fill) {
+  return get(Key{Kind::Ellipse, width, height, fill},
+             [&] { return collision::ellipse(width, height, fill); });
+}
+
+std::shared_ptr<const Shape> ShapeCache::rectangle(size_t width, size_t height, Pixel fill) {
+  return get(Key{Kind::Rectangle, width, height, fill},
+             [&] { return collision::rectangle(width, height, fill); });
+}
+
+size_t ShapeCache::size() const {
+  return m_shapes.size();
+}
+
+void ShapeCache::clear() {
+  m_shapes.clear();
+}
+
+template <typename F>
+std::shared_ptr<const Shape> ShapeCache::get(const Key& key, F create) {
+  auto it = m_shapes.find(key);
+  if (it == m_shapes.end()) {
+    it = m_shapes.emplace(key, std::make_shared<const Shape>(create())).first;
+  }
+  return it->second;
+}
+
+}
+}
+}
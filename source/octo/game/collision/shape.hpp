@@ -0,0 +1,90 @@
+#pragma once
+
+#include "bitmask.hpp"
+#include "mask.hpp"
+#include "occupancy.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/*! \brief A collision mask together with the data derived from it for overlap tests.
+ *
+ *  Shapes are shared between all entities of the same kind through a \ref ShapeCache and are
+ *  immutable while shared. Only an exclusively owned shape may be modified.
+ */
+struct Shape {
+  /// the pixels of the shape
+  Mask mask;
+  /// the bit-packed solidity of \ref mask, kept in sync by \ref update
+  BitMask solidity;
+  /// the empty and full blocks of \ref solidity, kept in sync by \ref update
+  OccupancyPyramid occupancy;
+
+  /*! \brief Initializes the shape from its pixels.
+   */
+  explicit Shape(Mask mask);
+
+  /*! \brief Creates an independent copy of \p other, including its pixels.
+   */
+  Shape(const Shape& other);
+
+  /*! \brief Updates the derived data after some pixels of \ref mask have been modified.
+   *  \param region the modified pixels.
+   */
+  void update(const sf::Rect<size_t>& region);
+};
+
+/*! \brief Creates each distinct shape only once and shares it afterwards.
+ *
+ *  Spawning an entity with a cached shape allocates nothing but a reference count, and all
+ *  entities of the same kind test overlaps against the same pixels.
+ *
+ *  The cache is not thread-safe, it belongs to the World and is used by the simulation only.
+ */
+class ShapeCache {
+public:
+  /*! \brief The shared shape of collision::circle(\p radius, \p fill).
+   */
+  std::shared_ptr<const Shape> circle(size_t radius, Pixel fill);
+
+  /*! \brief The shared shape of collision::ellipse(\p width, \p height, \p fill).
+   */
+  std::shared_ptr<const Shape> ellipse(size_t width, size_t height, Pixel fill);
+
+  /*! \brief The shared shape of collision::rectangle(\p width, \p height, \p fill).
+   */
+  std::shared_ptr<const Shape> rectangle(size_t width, size_t height, Pixel fill);
+
+  /// the number of distinct shapes
+  size_t size() const;
+
+  /*! \brief Forgets all shapes.
+   *
+   *  Shapes still referenced by entities stay alive until those are gone.
+   */
+  void clear();
+
+private:
+  enum class Kind { Circle, Ellipse, Rectangle };
+
+  /// the parameters a shape is created from
+  using Key = std::tuple<Kind, size_t, size_t, Pixel>;
+
+  /// Looks up the shape for \p key, creating it from the mask returned by \p create if necessary.
+  template <typename F>
+  std::shared_ptr<const Shape> get(const Key& key, F create);
+
+  std::map<Key, std::shared_ptr<const Shape>> m_shapes;
+};
+
+}
+}
+}
@@ -0,0 +1,79 @@
+#include "spatialhash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+SpatialHash::SpatialHash(float cellSize) {
+  setCellSize(cellSize);
+}
+
+float SpatialHash::cellSize() const {
+  return m_cellSize;
+}
+
+void SpatialHash::setCellSize(float cellSize) {
+  m_cellSize = cellSize;
+  m_inverseCellSize = 1 / cellSize;
+}
+
+void SpatialHash::clear() {
+  m_boxes.clear();
+  m_entries.clear();
+}
+
+SpatialHash::CellKey SpatialHash::key(int x, int y) {
+  return (static_cast<CellKey>(static_cast<std::uint32_t>(y)) << 32) |
+         static_cast<std::uint32_t>(x);
+}
+
+int SpatialHash::cellCoord(float v) const {
+  return static_cast<int>(std::floor(v * m_inverseCellSize));
+}
+
+void SpatialHash::insert(const sf::FloatRect& aabb) {
+  size_t index = m_boxes.size();
+  m_boxes.push_back(aabb);
+  int x0 = cellCoord(aabb.left);
+  int x1 = cellCoord(aabb.left + aabb.width);
+  int y0 = cellCoord(aabb.top);
+  int y1 = cellCoord(aabb.top + aabb.height);
+  for (int y = y0; y <= y1; ++y) {
+    for (int x = x0; x <= x1; ++x) {
+      m_entries.emplace_back(key(x, y), index);
+    }
+  }
+}
+
+void SpatialHash::findPairs(std::vector<std::pair<size_t, size_t>>& pairs) {
+  pairs.clear();
+  std::sort(begin(m_entries), end(m_entries));
+  for (auto cellBegin = begin(m_entries); cellBegin != end(m_entries);) {
+    auto cellEnd = std::find_if(
+        cellBegin, end(m_entries), [&](const auto& e) { return e.first != cellBegin->first; });
+    for (auto a = cellBegin; a != cellEnd; ++a) {
+      for (auto b = a + 1; b != cellEnd; ++b) {
+        const sf::FloatRect& boxA = m_boxes[a->second];
+        const sf::FloatRect& boxB = m_boxes[b->second];
+        sf::FloatRect intersection;
+        if (boxA.intersects(boxB, intersection)) {
+          // two boxes might share several cells, only report them in the cell
+          // containing the top left corner of their intersection
+          if (key(cellCoord(intersection.left), cellCoord(intersection.top)) == a->first) {
+            pairs.emplace_back(a->second, b->second);
+          }
+        }
+      }
+    }
+    cellBegin = cellEnd;
+  }
+  std::sort(begin(pairs), end(pairs));
+}
+
+}
+}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Config.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/*! \brief A uniform grid used for finding pairs of overlapping bounding boxes.
+ *
+ *  Every bounding box is registered in all grid cells it touches. Only boxes sharing a cell
+ *  are tested against each other, hence the cost grows with the number of nearby objects
+ *  instead of the square of the number of all objects.
+ *
+ *  The cells are not stored explicitly, instead, the (cell, object) entries are sorted
+ *  by cell, which makes the result independent of any hashing order.
+ */
+class SpatialHash {
+public:
+  /*! \brief Initializes an empty grid.
+   *  \param cellSize the edge length of the square grid cells in world units.
+   */
+  explicit SpatialHash(float cellSize = 64);
+
+  /// the edge length of the grid cells
+  float cellSize() const;
+
+  /// sets the edge length of the grid cells, only affects objects inserted afterwards
+  void setCellSize(float cellSize);
+
+  /*! \brief Removes all objects from the grid.
+   */
+  void clear();
+
+  /*! \brief Registers a bounding box.
+   *
+   *  The objects are identified by the order of insertion, i.e. the first object
+   *  inserted after \ref clear has index 0.
+   *
+   *  \param aabb the world space bounding box of the object.
+   */
+  void insert(const sf::FloatRect& aabb);
+
+  /*! \brief Finds all pairs of objects whose bounding boxes intersect.
+   *
+   *  Every pair is reported exactly once, with the smaller index first.
+   *  The pairs are sorted in lexicographic order.
+   *
+   *  \param pairs receives the overlapping pairs, previous contents are discarded.
+   */
+  void findPairs(std::vector<std::pair<size_t, size_t>>& pairs);
+
+private:
+  /// A combined cell coordinate.
+  using CellKey = sf::Uint64;
+
+  /// Combines two cell coordinates into a single key.
+  static CellKey key(int x, int y);
+
+  /// Computes the cell coordinate containing the position \p v.
+  int cellCoord(float v) const;
+
+  float m_cellSize;
+  float m_inverseCellSize;
+  /// bounding boxes of the registered objects
+  std::vector<sf::FloatRect> m_boxes;
+  /// (cell, object index) entries
+  std::vector<std::pair<CellKey, size_t>> m_entries;
+};
+
+}
+}
+}
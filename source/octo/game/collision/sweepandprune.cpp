@@ -0,0 +1,147 @@
+#include "sweepandprune.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+SweepAndPrune::Proxy SweepAndPrune::insert(const sf::FloatRect& aabb) {
+  Proxy proxy;
+  if (m_free.empty()) {
+    proxy = m_boxes.size();
+    m_boxes.emplace_back();
+  } else {
+    proxy = m_free.back();
+    m_free.pop_back();
+  }
+  Box& box = m_boxes[proxy];
+  box.alive = true;
+  // the new endpoints are appended behind all others, as if the box was moved in from infinity,
+  // the next update sorts them into place and reports the overlaps on the way
+  for (int axis = 0; axis < 2; ++axis) {
+    for (int isMax = 0; isMax < 2; ++isMax) {
+      box.endpoints[axis][isMax] = m_endpoints[axis].size();
+      m_endpoints[axis].push_back({0, proxy, isMax != 0});
+    }
+  }
+  setBounds(box, aabb);
+  return proxy;
+}
+
+void SweepAndPrune::remove(Proxy proxy) {
+  Box& box = m_boxes[proxy];
+  assert(box.alive);
+  // move the box out to infinity, the next update then ends all its overlaps and
+  // sorts its endpoints to the back of the lists where they can be dropped
+  const float infinity = std::numeric_limits<float>::infinity();
+  box.alive = false;
+  for (int axis = 0; axis < 2; ++axis) {
+    box.min[axis] = box.max[axis] = infinity;
+    for (int isMax = 0; isMax < 2; ++isMax) {
+      m_endpoints[axis][box.endpoints[axis][isMax]].value = infinity;
+    }
+  }
+  m_removed.push_back(proxy);
+}
+
+void SweepAndPrune::move(Proxy proxy, const sf::FloatRect& aabb) {
+  Box& box = m_boxes[proxy];
+  assert(box.alive);
+  setBounds(box, aabb);
+}
+
+void SweepAndPrune::update() {
+  sortAxis(0);
+  sortAxis(1);
+  // removed boxes were sorted to the back, all other endpoints are finite
+  for (auto& endpoints : m_endpoints) {
+    while (!endpoints.empty() && !m_boxes[endpoints.back().proxy].alive) {
+      endpoints.pop_back();
+    }
+  }
+  m_free.insert(end(m_free), begin(m_removed), end(m_removed));
+  m_removed.clear();
+}
+
+void SweepAndPrune::clear() {
+  m_boxes.clear();
+  m_endpoints[0].clear();
+  m_endpoints[1].clear();
+  m_free.clear();
+  m_removed.clear();
+  m_pairs.clear();
+}
+
+size_t SweepAndPrune::capacity() const {
+  return m_boxes.size();
+}
+
+void SweepAndPrune::findPairs(std::vector<std::pair<Proxy, Proxy>>& pairs) const {
+  pairs.clear();
+  pairs.reserve(m_pairs.size());
+  for (sf::Uint64 key : m_pairs) {
+    pairs.emplace_back(static_cast<Proxy>(key >> 32), static_cast<Proxy>(key & 0xffffffff));
+  }
+  std::sort(begin(pairs), end(pairs));
+}
+
+sf::Uint64 SweepAndPrune::pairKey(Proxy a, Proxy b) {
+  if (b < a) {
+    std::swap(a, b);
+  }
+  return (static_cast<sf::Uint64>(a) << 32) | static_cast<sf::Uint64>(b);
+}
+
+bool SweepAndPrune::less(const Endpoint& a, const Endpoint& b) {
+  // a maximum precedes a minimum of the same value, so that touching intervals are separated
+  return a.value < b.value || (a.value == b.value && a.isMax && !b.isMax);
+}
+
+void SweepAndPrune::setBounds(Box& box, const sf::FloatRect& aabb) {
+  box.min[0] = aabb.left;
+  box.max[0] = aabb.left + aabb.width;
+  box.min[1] = aabb.top;
+  box.max[1] = aabb.top + aabb.height;
+  for (int axis = 0; axis < 2; ++axis) {
+    m_endpoints[axis][box.endpoints[axis][0]].value = box.min[axis];
+    m_endpoints[axis][box.endpoints[axis][1]].value = box.max[axis];
+  }
+}
+
+bool SweepAndPrune::overlaps(const Box& a, const Box& b) const {
+  return a.alive && b.alive && a.min[0] < b.max[0] && b.min[0] < a.max[0] &&
+         a.min[1] < b.max[1] && b.min[1] < a.max[1];
+}
+
+void SweepAndPrune::sortAxis(int axis) {
+  std::vector<Endpoint>& endpoints = m_endpoints[axis];
+  for (size_t i = 1; i < endpoints.size(); ++i) {
+    Endpoint moving = endpoints[i];
+    size_t j = i;
+    for (; j > 0 && less(moving, endpoints[j - 1]); --j) {
+      const Endpoint& passed = endpoints[j - 1];
+      if (passed.proxy != moving.proxy && passed.isMax != moving.isMax) {
+        if (passed.isMax) {
+          // a minimum moved below a maximum, the intervals overlap on this axis now
+          if (overlaps(m_boxes[moving.proxy], m_boxes[passed.proxy])) {
+            m_pairs.insert(pairKey(moving.proxy, passed.proxy));
+          }
+        } else {
+          // a maximum moved below a minimum, the intervals are separated on this axis now
+          m_pairs.erase(pairKey(moving.proxy, passed.proxy));
+        }
+      }
+      endpoints[j] = passed;
+      m_boxes[passed.proxy].endpoints[axis][passed.isMax] = j;
+    }
+    endpoints[j] = moving;
+    m_boxes[moving.proxy].endpoints[axis][moving.isMax] = j;
+  }
+}
+
+}
+}
+}
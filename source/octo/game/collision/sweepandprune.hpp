@@ -0,0 +1,119 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Config.hpp>
+
+#include <cstddef>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace collision {
+
+/*! \brief An incremental broadphase finding pairs of overlapping bounding boxes.
+ *
+ *  The minimum and maximum of every box are kept in a sorted list per axis. Since objects
+ *  usually move only a little between two updates, these lists are nearly sorted already and
+ *  are re-sorted using insertion sort, which takes linear time in that case.
+ *
+ *  Every swap of a minimum and a maximum of two different boxes means that their intervals
+ *  started or stopped to overlap on that axis. These swaps are used to maintain the set of
+ *  overlapping pairs between updates, instead of recomputing it from scratch.
+ */
+class SweepAndPrune {
+public:
+  /// Identifies a box registered in the broadphase.
+  using Proxy = size_t;
+
+  /*! \brief Registers a bounding box.
+   *
+   *  The pairs involving the new box are reported after the next \ref update.
+   *
+   *  \param aabb the world space bounding box of the object, must be finite.
+   *  \return the identifier of the box, which may be reused after the box was removed.
+   */
+  Proxy insert(const sf::FloatRect& aabb);
+
+  /*! \brief Unregisters a bounding box.
+   *
+   *  All pairs involving the box are removed with the next \ref update.
+   */
+  void remove(Proxy proxy);
+
+  /*! \brief Changes the bounding box of an object.
+   *
+   *  The box is only sorted into place by the next \ref update.
+   *
+   *  \param proxy the box to change.
+   *  \param aabb the new world space bounding box, must be finite.
+   */
+  void move(Proxy proxy, const sf::FloatRect& aabb);
+
+  /*! \brief Re-sorts the endpoint lists and updates the set of overlapping pairs.
+   */
+  void update();
+
+  /*! \brief Removes all boxes.
+   */
+  void clear();
+
+  /// an upper bound on the identifiers of the boxes currently registered
+  size_t capacity() const;
+
+  /*! \brief Reports all pairs of boxes whose bounding boxes intersect as of the last \ref update.
+   *
+   *  Every pair is reported exactly once, with the smaller identifier first.
+   *  The pairs are sorted in lexicographic order.
+   *
+   *  \param pairs receives the overlapping pairs, previous contents are discarded.
+   */
+  void findPairs(std::vector<std::pair<Proxy, Proxy>>& pairs) const;
+
+private:
+  /// The minimum or maximum of a box on one axis.
+  struct Endpoint {
+    float value;
+    Proxy proxy;
+    bool isMax;
+  };
+
+  /// A registered box.
+  struct Box {
+    float min[2];
+    float max[2];
+    /// the positions of the minimum and maximum in the endpoint lists, indexed by axis
+    size_t endpoints[2][2];
+    bool alive;
+  };
+
+  /// Combines two proxies into a key of the pair set, independent of their order.
+  static sf::Uint64 pairKey(Proxy a, Proxy b);
+
+  /// The order of the endpoint lists, touching intervals do not overlap.
+  static bool less(const Endpoint& a, const Endpoint& b);
+
+  /// Stores the bounds of \p aabb in \p box and its endpoints.
+  void setBounds(Box& box, const sf::FloatRect& aabb);
+
+  /// Checks whether two live boxes overlap on both axes.
+  bool overlaps(const Box& a, const Box& b) const;
+
+  /// Sorts the endpoints of one axis, updating the pair set on every swap.
+  void sortAxis(int axis);
+
+  std::vector<Box> m_boxes;
+  /// the endpoint lists, indexed by axis
+  std::vector<Endpoint> m_endpoints[2];
+  /// proxies of removed boxes which can be reused
+  std::vector<Proxy> m_free;
+  /// the removed boxes whose endpoints are still sorted out of the lists
+  std::vector<Proxy> m_removed;
+  /// the currently overlapping pairs, see \ref pairKey
+  std::unordered_set<sf::Uint64> m_pairs;
+};
+
+}
+}
+}
@@ -1,5 +1,7 @@
 #include "util.hpp"
 
+#include <algorithm>
+
 namespace octo {
 namespace game {
 namespace collision {
@@ -29,6 +31,19 @@ sf::Vector2f computeNormal(const Mask& mask, int accuracy, const sf::Vector2f& p
   return computeNormal(mask, accuracy, std::round(point.x), std::round(point.y));
 }
 
+sf::Vector2f computeNormal(const components::CollisionMask& collision, int accuracy,
+                           const sf::Vector2f& point) {
+  if (collision.distanceField) {
+    sf::Vector2f clamped{
+        std::max(0.f, std::min(std::round(point.x), collision.size().x - 1)),
+        std::max(0.f, std::min(std::round(point.y), collision.size().y - 1)),
+    };
+    return collision.distanceField->normal(static_cast<size_t>(clamped.x),
+                                           static_cast<size_t>(clamped.y));
+  }
+  return computeNormal(collision.mask(), accuracy, point.x, point.y);
+}
+
 }
 }
 }
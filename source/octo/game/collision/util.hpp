@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../components.hpp"
+#include "aabbtree.hpp"
 #include "mask.hpp"
 #include <octo/math/rect.hpp>
 
@@ -8,6 +9,9 @@
 #include <entityx/entityx.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
 
 namespace octo {
 namespace game {
@@ -39,24 +43,48 @@ struct AabbQueryData {
   sf::Rect<size_t> intersectionMask{};
 };
 
+/*! \brief Finds all entities whose bounding box intersects a given box.
+ *
+ *  The candidates are looked up in \p tree, e.g. World::aabbTree, and then checked
+ *  using their current bounding boxes. Since all candidates are collected first, the
+ *  callback may destroy entities, even ones stored in \p tree.
+ *
+ *  \param em the entity manager owning the entities stored in \p tree.
+ *  \param tree the bounding boxes of the entities, with entity ids as user data.
+ *  \param queryAABB the query box in world coordinates.
+ *  \param callback called as \c callback(entity, data) with an AabbQueryData for every hit.
+ */
 template <typename F>
-void aabbQuery(entityx::EntityManager& em, const sf::FloatRect& queryAABB, F callback) {
+void aabbQuery(entityx::EntityManager& em, const AabbTree& tree, const sf::FloatRect& queryAABB,
+               F callback) {
   using namespace components;
-  em.each<Spatial, CollisionMask>(
-      [&](entityx::Entity obj, Spatial& spatial, CollisionMask& collision) {
-        AabbQueryData data{obj, spatial, collision};
-        data.maskToGlobal = maskToGlobal(spatial.current(), collision);
-        sf::FloatRect localBounds = {{0.f, 0.f}, collision.size()};
-        sf::FloatRect objAABB = data.maskToGlobal.transformRect(localBounds);
-        if (objAABB.intersects(queryAABB, data.intersectionGlobal)) {
-          data.globalToMask = globalToMask(spatial.current(), collision);
-          sf::FloatRect localIntersection;
-          localBounds.intersects(data.globalToMask.transformRect(data.intersectionGlobal),
-                                 localIntersection);
-          data.intersectionMask = math::rect::integralOutwards<size_t>(localIntersection);
-          callback(obj, data);
-        }
-      });
+  std::vector<std::uint64_t> candidates;
+  tree.query(queryAABB,
+             [&](AabbTree::Proxy, std::uint64_t id) { candidates.push_back(id); });
+  for (std::uint64_t id : candidates) {
+    entityx::Entity::Id entityId(id);
+    if (!em.valid(entityId)) {
+      continue;
+    }
+    entityx::Entity obj = em.get(entityId);
+    auto spatial = obj.component<Spatial>();
+    auto collision = obj.component<CollisionMask>();
+    if (!spatial || !collision) {
+      continue;
+    }
+    AabbQueryData data{obj, *spatial, *collision};
+    data.maskToGlobal = maskToGlobal(spatial->current(), *collision);
+    sf::FloatRect localBounds = {{0.f, 0.f}, collision->size()};
+    sf::FloatRect objAABB = data.maskToGlobal.transformRect(localBounds);
+    if (objAABB.intersects(queryAABB, data.intersectionGlobal)) {
+      data.globalToMask = globalToMask(spatial->current(), *collision);
+      sf::FloatRect localIntersection;
+      localBounds.intersects(data.globalToMask.transformRect(data.intersectionGlobal),
+                             localIntersection);
+      data.intersectionMask = math::rect::integralOutwards<size_t>(localIntersection);
+      callback(obj, data);
+    }
+  }
 }
 
 /*! \brief Approximates the surface normal by averaging over all solid pixels
@@ -79,47 +107,47 @@ sf::Vector2f computeNormal(const Mask& mask, int accuracy, size_t x, size_t y);
 
 sf::Vector2f computeNormal(const Mask& mask, int accuracy, const sf::Vector2f& point);
 
-template <typename Callback>
-sf::Vector2f bresenhamLine(sf::Vector2f& start, sf::Vector2f& end, Callback callback) {
-  const bool steep = (std::fabs(end.y - start.y) > std::fabs(end.x - start.x));
-  if (steep) {
-    std::swap(start.x, start.y);
-    std::swap(end.x, end.y);
-  }
-
-  if (start.x > end.x) {
-    std::swap(start.x, end.x);
-    std::swap(start.y, end.y);
-  }
-
-  const float dx = end.x - start.x;
-  const float dy = fabs(end.y - start.y);
-
-  float error = dx / 2.0f;
-  const int ystep = (start.y < end.y) ? 1 : -1;
-  int y = static_cast<int>(start.y);
-
-  const int maxX = static_cast<int>(end.x);
-
-  sf::Vector2f cur;
+/*! \brief Computes the surface normal of a collision mask component.
+ *
+ *  If the component maintains a distance field, the normal is derived from its gradient
+ *  in constant time. Otherwise, it falls back to averaging the solid pixels in a square.
+ *
+ *  \param collision the collision mask component.
+ *  \param accuracy the accuracy used when falling back to averaging.
+ *  \param point the point of interest in mask coordinates.
+ *  \returns an approximated surface normal at \p point.
+ */
+sf::Vector2f computeNormal(const components::CollisionMask& collision, int accuracy,
+                           const sf::Vector2f& point);
 
-  for (int x = static_cast<int>(start.x); x < maxX; x++) {
-    bool ret;
-    if (steep) {
-      cur = { static_cast<float>(y), static_cast<float>(x) };
-      ret = callback(y, x);
+/*! \brief Visits the pixels on a line from \p start to \p end in order.
+ *
+ *  The line is rasterized with Bresenham's algorithm.
+ *
+ *  Consecutive pixels share an edge, so the line cannot slip through diagonal gaps of a mask.
+ *
+ *  \param start the first point, rounded to the nearest pixel.
+ *  \param end the last point, rounded to the nearest pixel.
+ *  \param callback called as \c callback(x, y) for every pixel, returning \c false stops the line.
+ *  \returns the last visited pixel.
+ */
+template <typename Callback>
+sf::Vector2i bresenhamLine(const sf::Vector2f& start, const sf::Vector2f& end, Callback callback) {
+  sf::Vector2i cur(static_cast<int>(std::round(start.x)), static_cast<int>(std::round(start.y)));
+  const sf::Vector2i last(static_cast<int>(std::round(end.x)), static_cast<int>(std::round(end.y)));
+  const int dx = std::abs(last.x - cur.x);
+  const int dy = -std::abs(last.y - cur.y);
+  const int xstep = cur.x < last.x ? 1 : -1;
+  const int ystep = cur.y < last.y ? 1 : -1;
+  int error = dx + dy;
+  while (callback(cur.x, cur.y) && cur != last) {
+    // step along the axis that keeps the pixel closer to the line
+    if (2 * error - dy > dx - 2 * error) {
+      error += dy;
+      cur.x += xstep;
     } else {
-      cur = { static_cast<float>(x), static_cast<float>(y) };
-      ret = callback(x, y);
-    }
-    if(! ret) {
-      return cur;
-    }
-
-    error -= dy;
-    if (error < 0) {
-      y += ystep;
       error += dx;
+      cur.y += ystep;
     }
   }
   return cur;
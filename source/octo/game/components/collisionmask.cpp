@@ -4,12 +4,42 @@ namespace octo {
 namespace game {
 namespace components {
 
-CollisionMask::CollisionMask() : mask(0, 0), anchor(0, 0) {}
+CollisionMask::CollisionMask() : CollisionMask(collision::Mask(0, 0)) {}
 
-CollisionMask::CollisionMask(collision::Mask mask) : mask(std::move(mask)), anchor(0, 0) {}
+CollisionMask::CollisionMask(collision::Mask mask) : CollisionMask(std::move(mask), {0, 0}) {}
 
-CollisionMask::CollisionMask(collision::Mask mask, sf::Vector2f anchor)
-    : mask(std::move(mask)), anchor(anchor) {}
+CollisionMask::CollisionMask(collision::Mask mask, sf::Vector2f anchor) : anchor(anchor) {
+  auto owned = std::make_shared<collision::Shape>(std::move(mask));
+  m_ownedShape = owned.get();
+  m_shape = std::move(owned);
+}
+
+CollisionMask::CollisionMask(std::shared_ptr<const collision::Shape> shape, sf::Vector2f anchor)
+    : anchor(anchor), m_shape(std::move(shape)), m_ownedShape(nullptr) {}
+
+collision::Mask& CollisionMask::modifyMask() {
+  if (!m_ownedShape) {
+    auto owned = std::make_shared<collision::Shape>(*m_shape);
+    m_ownedShape = owned.get();
+    m_shape = std::move(owned);
+  }
+  return m_ownedShape->mask;
+}
+
+void CollisionMask::enableDistanceField(float maxDistance) {
+  distanceField = std::make_unique<collision::DistanceField>(mask(), maxDistance);
+}
+
+void CollisionMask::update(const sf::Rect<size_t>& region) {
+  if (!m_ownedShape) {
+    // nothing can have changed without modifyMask
+    return;
+  }
+  m_ownedShape->update(region);
+  if (distanceField) {
+    distanceField->update(mask(), region);
+  }
+}
 }
 }
 }
@@ -1,20 +1,34 @@
 #pragma once
 
+#include <octo/game/collision/bitmask.hpp>
+#include <octo/game/collision/distancefield.hpp>
 #include <octo/game/collision/mask.hpp>
+#include <octo/game/collision/occupancy.hpp>
+#include <octo/game/collision/shape.hpp>
 #include <octo/math/vector.hpp>
 
 #include <SFML/Config.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <memory>
 
 namespace octo {
 namespace game {
 namespace components {
 
 /*! \brief Component defining a planet, consisting of its terrain mask and texture.
+ *
+ *  The shape of the entity might be shared with other entities, e.g. all bullets of the same
+ *  kind use the same pixels. A shared shape is copied on the first call to \ref modifyMask,
+ *  afterwards the entity owns its shape exclusively.
  */
 struct CollisionMask {
-  /*! \brief Collision mask representing the shape of the entity.
+  /*! \brief Optional signed distance field of \ref mask, used for computing surface normals.
+   *
+   *  Only worth its memory for large masks that are frequently involved in collisions.
+   *  \see enableDistanceField
    */
-  collision::Mask mask;
+  std::unique_ptr<collision::DistanceField> distanceField;
   /*! \brief The position of the collision masks center in the entities local coordinate system.
    */
   sf::Vector2f anchor;
@@ -26,14 +40,72 @@ struct CollisionMask {
   sf::Uint64 selector = 0xFFFFFFFFFFFFFFFFUL;
 
   sf::Vector2f size() const {
-    return math::vector::vector_cast<float>(mask.size());
+    return math::vector::vector_cast<float>(m_shape->mask.size());
   }
 
   CollisionMask();
 
+  /*! \brief Initializes the component with an exclusively owned shape.
+   */
   CollisionMask(collision::Mask mask);
 
   CollisionMask(collision::Mask mask, sf::Vector2f anchor);
+
+  /*! \brief Initializes the component with a possibly shared shape.
+   *
+   *  \param shape the shape, usually from a collision::ShapeCache.
+   *  \param anchor the position of the shape's center in the entities local coordinate system.
+   */
+  CollisionMask(std::shared_ptr<const collision::Shape> shape, sf::Vector2f anchor = {0, 0});
+
+  /// Collision mask representing the shape of the entity.
+  const collision::Mask& mask() const {
+    return m_shape->mask;
+  }
+
+  /// Bit-packed solidity of \ref mask, used for fast overlap tests.
+  const collision::BitMask& solidity() const {
+    return m_shape->solidity;
+  }
+
+  /// Empty and full blocks of \ref solidity, used for skipping whole blocks in overlap tests.
+  const collision::OccupancyPyramid& occupancy() const {
+    return m_shape->occupancy;
+  }
+
+  /// The shape of the entity, which might be shared.
+  const std::shared_ptr<const collision::Shape>& shape() const {
+    return m_shape;
+  }
+
+  /// whether the shape is owned exclusively by this component, i.e. not shared
+  bool ownsShape() const {
+    return m_ownedShape != nullptr;
+  }
+
+  /*! \brief Gives write access to the pixels of the mask.
+   *
+   *  A shared shape is copied first, hence references obtained from \ref mask before might
+   *  refer to the old pixels afterwards. The derived data must be kept in sync by calling
+   *  \ref update after modifying the pixels.
+   */
+  collision::Mask& modifyMask();
+
+  /*! \brief Computes and maintains a \ref distanceField for this mask.
+   *  \param maxDistance the distance at which the field is truncated,
+   *  should be at least the accuracy used for computing normals.
+   */
+  void enableDistanceField(float maxDistance = 8);
+
+  /*! \brief Updates the data derived from \ref mask after some of its pixels have been modified.
+   *  \param region the modified pixels.
+   */
+  void update(const sf::Rect<size_t>& region);
+
+private:
+  std::shared_ptr<const collision::Shape> m_shape;
+  /// the same shape as \ref m_shape if it is owned exclusively, otherwise null
+  collision::Shape* m_ownedShape;
 };
 
 }
@@ -0,0 +1,24 @@
+#include "debugdata.hpp"
+
+#include <octo/math/rect.hpp>
+
+namespace octo {
+namespace game {
+namespace components {
+
+constexpr size_t MaskImage::History;
+
+bool MaskImage::changedSince(sf::Uint64 older, sf::Rect<unsigned>& changed) const {
+  if (older >= revision || revision - older > History) {
+    return false;
+  }
+  changed = {};
+  for (sf::Uint64 r = older + 1; r <= revision; ++r) {
+    changed = math::rect::merge(changed, changes[r % History]);
+  }
+  return true;
+}
+
+}
+}
+}
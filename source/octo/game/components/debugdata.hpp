@@ -1,15 +1,52 @@
 #pragma once
 
-#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Config.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <array>
+#include <memory>
 
 namespace octo {
 namespace game {
 namespace components {
 
+/*! \brief An immutable image of a collision mask, remembering which pixels recent revisions changed.
+ *
+ *  Every modification of the mask creates a new revision from the previous one. Consumers holding
+ *  an older revision of the same entity can then update only the changed pixels.
+ */
+struct MaskImage {
+  /// the number of revisions whose changes are remembered
+  static constexpr size_t History = 8;
+
+  /// the pixels of the mask
+  sf::Image image;
+  /// zero for images created from scratch, otherwise the revision of its predecessor plus one
+  sf::Uint64 revision = 0;
+  /// the pixels changed by revision \c r relative to its predecessor, at index \c r%History
+  std::array<sf::Rect<unsigned>, History> changes;
+
+  /*! \brief Determines the pixels changed since an older revision of the same lineage.
+   *
+   *  \param older the revision whose pixels are known.
+   *  \param changed receives the bounding rectangle of all changes since \p older.
+   *  \returns \c false if the changes are not known, because \p older is too old or no
+   *  predecessor of this revision.
+   */
+  bool changedSince(sf::Uint64 older, sf::Rect<unsigned>& changed) const;
+};
+
 /*! \brief Component storing data only relevant for debugging.
  */
 struct DebugData {
-  sf::Texture collisionMaskTexture;
+  /*! \brief An image of the collision mask.
+   *
+   *  The image is replaced, never modified, when the mask changes. This allows sharing it with
+   *  snapshots read by the render thread. It is kept on the CPU side, since textures can only
+   *  be created on the render thread.
+   */
+  std::shared_ptr<const MaskImage> collisionMaskImage;
 };
 
 }
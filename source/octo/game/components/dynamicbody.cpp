@@ -9,6 +9,14 @@
 
 using namespace octo::game::components;
 
+namespace {
+/// The log shared by all bodies, created once instead of on every call.
+fmtlog::Log& bodyLog() {
+  static fmtlog::Log log = fmtlog::For<DynamicBody>();
+  return log;
+}
+}
+
 DynamicBody::DynamicBody(float mass, float inertia) {
   setMass(mass);
   setInertia(inertia);
@@ -42,15 +50,14 @@ void DynamicBody::applyForce(const sf::Vector2f& localPosition, const sf::Vector
 
     float generatedTorque = math::vector::cross2d(r, appliedForce);
 
-    fmtlog::Log(fmtlog::For<DynamicBody>())
-        .debug("apply force {%f, %f} to {%f, %f}; r: {%f, %f} torque: %f",
-               appliedForce.x,
-               force.y,
-               localPosition.x,
-               localPosition.y,
-               r.x,
-               r.y,
-               generatedTorque);
+    bodyLog().debug("apply force {%f, %f} to {%f, %f}; r: {%f, %f} torque: %f",
+                    appliedForce.x,
+                    appliedForce.y,
+                    localPosition.x,
+                    localPosition.y,
+                    r.x,
+                    r.y,
+                    generatedTorque);
 
     // update force & torque
     this->force += appliedForce;
@@ -66,15 +73,14 @@ void DynamicBody::applyLinearImpulse(const sf::Vector2f& localPosition, const sf
 
     float angularImpulse = math::vector::cross2d(r, impulse);
 
-    fmtlog::Log(fmtlog::For<DynamicBody>())
-        .debug("apply impulse {%f, %f} to {%f, %f}; r: {%f, %f} angular impulse: %f",
-               impulse.x,
-               impulse.y,
-               localPosition.x,
-               localPosition.y,
-               r.x,
-               r.y,
-               angularImpulse);
+    bodyLog().debug("apply impulse {%f, %f} to {%f, %f}; r: {%f, %f} angular impulse: %f",
+                    impulse.x,
+                    impulse.y,
+                    localPosition.x,
+                    localPosition.y,
+                    r.x,
+                    r.y,
+                    angularImpulse);
 
     // update force & torque
     this->linearMomentum += impulse;
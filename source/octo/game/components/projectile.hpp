@@ -9,8 +9,19 @@ namespace components {
  *  \idea add logic (i.e. scripting) to projectiles
  */
 struct Projectile {
+  /// How a projectile is tested against the collision masks of other entities.
+  enum class Hitbox {
+    /// its own collision mask is overlapped with theirs
+    Mask,
+    /// only the projectile's position is tested
+    Point,
+    /// the line from its previous to its current position is tested, it cannot skip thin walls
+    Segment,
+  };
+
   float explosionRadius;
   int bounceCounter = 0;
+  Hitbox hitbox = Hitbox::Mask;
 };
 
 }
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <octo/math/rect.hpp>
+
 #include <entityx/entityx.h>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstddef>
+#include <map>
 
 namespace octo {
 namespace game {
@@ -10,11 +16,37 @@ template <class T>
 struct ComponentModified {
   entityx::Entity entity;
   entityx::ComponentHandle<T> component;
+  /*! \brief The modified pixels of components consisting of pixels, like collision masks.
+   *
+   *  An empty region means that the whole component may have changed.
+   */
+  sf::Rect<size_t> region;
 
-  ComponentModified(entityx::Entity entityArg)
-    : entity(entityArg), component(entityArg.component<T>()) {}
+  ComponentModified(entityx::Entity entityArg, const sf::Rect<size_t>& regionArg = {})
+    : entity(entityArg), component(entityArg.component<T>()), region(regionArg) {}
 };
 
+/// The modified regions of several entities, see ComponentModified::region.
+using ModifiedRegions = std::map<entityx::Entity, sf::Rect<size_t>>;
+
+/*! \brief Adds the region of an event to the modified regions of its entity.
+ *
+ *  The regions of an entity are merged into their bounding rectangle. An empty region stands
+ *  for the whole component and absorbs all others.
+ */
+template <class T>
+void mergeModified(ModifiedRegions& regions, const ComponentModified<T>& event) {
+  auto inserted = regions.emplace(event.entity, event.region);
+  if (!inserted.second) {
+    sf::Rect<size_t>& region = inserted.first->second;
+    if (region.width > 0 && region.height > 0) {
+      region = event.region.width > 0 && event.region.height > 0
+                   ? math::rect::merge(region, event.region)
+                   : event.region;
+    }
+  }
+}
+
 }
 }
 }
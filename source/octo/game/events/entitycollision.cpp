@@ -6,8 +6,10 @@ namespace events {
 
 EntityCollision::EntityCollision(const std::array<entityx::Entity, 2>& collisionEntities,
                 const std::array<sf::Vector2f, 2>& collisionNormals,
-                const sf::Vector2f& contactPoint)
-  : entities(collisionEntities), normals(collisionNormals), contactPoint(contactPoint)
+                const sf::Vector2f& contactPoint,
+                float collisionTime)
+  : entities(collisionEntities), normals(collisionNormals), contactPoint(contactPoint),
+    timeOfImpact(collisionTime)
 {
 }
 
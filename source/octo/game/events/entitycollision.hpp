@@ -13,10 +13,17 @@ struct EntityCollision {
   std::array<entityx::Entity, 2> entities;
   std::array<sf::Vector2f, 2> normals;
   sf::Vector2f contactPoint;
+  /*! \brief The fraction of the last step at which the entities touched.
+   *
+   *  It is less than one if the collision was found on the path of a fast entity, the contact
+   *  point and normals refer to the positions interpolated at this time.
+   */
+  float timeOfImpact;
 
   EntityCollision(const std::array<entityx::Entity, 2>& collisionEntities,
                   const std::array<sf::Vector2f, 2>& collisionNormals,
-                  const sf::Vector2f& contactPoint);
+                  const sf::Vector2f& contactPoint,
+                  float collisionTime = 1);
 
   /*! \brief Swaps the order of the entities participating in the collision.
    */
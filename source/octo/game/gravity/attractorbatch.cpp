@@ -0,0 +1,149 @@
+#include "attractorbatch.hpp"
+
+#include <cmath>
+
+#if defined(__AVX__) || defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+namespace octo {
+namespace game {
+namespace gravity {
+
+#if defined(__AVX__)
+const size_t AttractorBatch::Width = 8;
+#elif defined(__SSE__)
+const size_t AttractorBatch::Width = 4;
+#else
+const size_t AttractorBatch::Width = 1;
+#endif
+
+namespace {
+/// Padding attractors are placed far away and have no intensity, hence exert no force.
+const float PaddingPosition = 1e15f;
+}
+
+void AttractorBatch::clear() {
+  m_size = 0;
+  m_x.clear();
+  m_y.clear();
+  m_intensity.clear();
+  m_radiusSq.clear();
+  m_insideScale.clear();
+}
+
+void AttractorBatch::add(const sf::Vector2f& position, float intensity, float radius) {
+  // overwrite padding if there is any
+  m_x.resize(m_size);
+  m_y.resize(m_size);
+  m_intensity.resize(m_size);
+  m_radiusSq.resize(m_size);
+  m_insideScale.resize(m_size);
+
+  // inside of the radius, the force is
+  //   delta / d * i * alpha / r^2   with   alpha = d * (3r^2 - d^2) / (2r^3)
+  // which simplifies to delta * i * (3r^2 - d^2) / (2r^5), avoiding the square root.
+  float radiusSq = radius * radius;
+  m_x.push_back(position.x);
+  m_y.push_back(position.y);
+  m_intensity.push_back(intensity);
+  m_radiusSq.push_back(radiusSq);
+  m_insideScale.push_back(intensity / (2 * radiusSq * radiusSq * radius));
+  m_size += 1;
+
+  size_t padded = (m_size + Width - 1) / Width * Width;
+  m_x.resize(padded, PaddingPosition);
+  m_y.resize(padded, PaddingPosition);
+  m_intensity.resize(padded, 0.f);
+  m_radiusSq.resize(padded, 0.f);
+  m_insideScale.resize(padded, 0.f);
+}
+
+bool AttractorBatch::empty() const {
+  return m_size == 0;
+}
+
+sf::Vector2f AttractorBatch::force(const sf::Vector2f& position, float intensity) const {
+  const size_t count = m_x.size();
+  const float* xs = m_x.data();
+  const float* ys = m_y.data();
+  const float* intensities = m_intensity.data();
+  const float* radiiSq = m_radiusSq.data();
+  const float* insideScales = m_insideScale.data();
+  float fx = 0;
+  float fy = 0;
+
+#if defined(__AVX__)
+  const __m256 px = _mm256_set1_ps(position.x);
+  const __m256 py = _mm256_set1_ps(position.y);
+  const __m256 three = _mm256_set1_ps(3.f);
+  __m256 sumX = _mm256_setzero_ps();
+  __m256 sumY = _mm256_setzero_ps();
+  for (size_t i = 0; i < count; i += 8) {
+    __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), px);
+    __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), py);
+    __m256 distSq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+    __m256 radiusSq = _mm256_loadu_ps(radiiSq + i);
+    __m256 outside = _mm256_div_ps(_mm256_loadu_ps(intensities + i),
+                                   _mm256_mul_ps(distSq, _mm256_sqrt_ps(distSq)));
+    __m256 inside = _mm256_mul_ps(_mm256_loadu_ps(insideScales + i),
+                                  _mm256_sub_ps(_mm256_mul_ps(three, radiusSq), distSq));
+    __m256 scale =
+        _mm256_blendv_ps(outside, inside, _mm256_cmp_ps(distSq, radiusSq, _CMP_LT_OQ));
+    sumX = _mm256_add_ps(sumX, _mm256_mul_ps(dx, scale));
+    sumY = _mm256_add_ps(sumY, _mm256_mul_ps(dy, scale));
+  }
+  alignas(32) float lanesX[8];
+  alignas(32) float lanesY[8];
+  _mm256_store_ps(lanesX, sumX);
+  _mm256_store_ps(lanesY, sumY);
+  for (int lane = 0; lane < 8; ++lane) {
+    fx += lanesX[lane];
+    fy += lanesY[lane];
+  }
+#elif defined(__SSE__)
+  const __m128 px = _mm_set1_ps(position.x);
+  const __m128 py = _mm_set1_ps(position.y);
+  const __m128 three = _mm_set1_ps(3.f);
+  __m128 sumX = _mm_setzero_ps();
+  __m128 sumY = _mm_setzero_ps();
+  for (size_t i = 0; i < count; i += 4) {
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), px);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), py);
+    __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+    __m128 radiusSq = _mm_loadu_ps(radiiSq + i);
+    __m128 outside = _mm_div_ps(_mm_loadu_ps(intensities + i),
+                                _mm_mul_ps(distSq, _mm_sqrt_ps(distSq)));
+    __m128 inside = _mm_mul_ps(_mm_loadu_ps(insideScales + i),
+                               _mm_sub_ps(_mm_mul_ps(three, radiusSq), distSq));
+    // select without SSE4.1 blend instructions
+    __m128 isInside = _mm_cmplt_ps(distSq, radiusSq);
+    __m128 scale = _mm_or_ps(_mm_and_ps(isInside, inside), _mm_andnot_ps(isInside, outside));
+    sumX = _mm_add_ps(sumX, _mm_mul_ps(dx, scale));
+    sumY = _mm_add_ps(sumY, _mm_mul_ps(dy, scale));
+  }
+  alignas(16) float lanesX[4];
+  alignas(16) float lanesY[4];
+  _mm_store_ps(lanesX, sumX);
+  _mm_store_ps(lanesY, sumY);
+  for (int lane = 0; lane < 4; ++lane) {
+    fx += lanesX[lane];
+    fy += lanesY[lane];
+  }
+#else
+  for (size_t i = 0; i < count; ++i) {
+    float dx = xs[i] - position.x;
+    float dy = ys[i] - position.y;
+    float distSq = dx * dx + dy * dy;
+    float scale = distSq < radiiSq[i] ? insideScales[i] * (3 * radiiSq[i] - distSq)
+                                      : intensities[i] / (distSq * std::sqrt(distSq));
+    fx += dx * scale;
+    fy += dy * scale;
+  }
+#endif
+  return sf::Vector2f(fx, fy) * intensity;
+}
+
+}
+}
+}
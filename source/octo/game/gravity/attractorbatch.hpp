@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace gravity {
+
+/*! \brief A set of attractors stored as structure of arrays.
+ *
+ *  The force exerted by all attractors in the batch is evaluated using SSE or AVX
+ *  instructions when the compiler targets them, processing 4 resp. 8 attractors at once.
+ *  Otherwise, a scalar loop over the same arrays is used.
+ *
+ *  The result matches gravity::attractionForce up to rounding errors, since the
+ *  inside-radius approximation is evaluated in an algebraically simplified form.
+ */
+class AttractorBatch {
+public:
+  /// the number of attractors evaluated at once
+  static const size_t Width;
+
+  /*! \brief Removes all attractors from the batch.
+   */
+  void clear();
+
+  /*! \brief Adds an attractor to the batch.
+   *
+   *  \param position the position of the attractor
+   *  \param intensity the intensity of the attractor
+   *  \param radius the radius of the attractor
+   */
+  void add(const sf::Vector2f& position, float intensity, float radius);
+
+  /*! \brief Checks whether the batch contains any attractors.
+   */
+  bool empty() const;
+
+  /*! \brief Computes the sum of the forces of all attractors in the batch.
+   *
+   *  \param position the position of the attractable.
+   *  \param intensity the intensity of the attractable.
+   *  \returns the force acting on the attractable.
+   */
+  sf::Vector2f force(const sf::Vector2f& position, float intensity) const;
+
+private:
+  /// the number of actual attractors, the arrays are padded to a multiple of \ref Width.
+  size_t m_size = 0;
+  std::vector<float> m_x;
+  std::vector<float> m_y;
+  std::vector<float> m_intensity;
+  std::vector<float> m_radiusSq;
+  /// \f$ \frac{i}{2r^5} \f$ with the intensity \f$ i \f$, used for the inside-radius approximation
+  std::vector<float> m_insideScale;
+};
+
+}
+}
+}
@@ -0,0 +1,157 @@
+#include "barneshut.hpp"
+
+#include "force.hpp"
+#include <octo/math/vector.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace octo {
+namespace game {
+namespace gravity {
+
+constexpr int BarnesHutTree::MaxDepth;
+
+void BarnesHutTree::clear() {
+  m_bodies.clear();
+  m_nodes.clear();
+}
+
+void BarnesHutTree::insert(const Body& body) {
+  m_bodies.push_back(body);
+}
+
+bool BarnesHutTree::empty() const {
+  return m_bodies.empty();
+}
+
+void BarnesHutTree::build() {
+  m_nodes.clear();
+  if (m_bodies.empty()) {
+    return;
+  }
+  // compute a square covering all attractors
+  sf::Vector2f minPos = m_bodies.front().position;
+  sf::Vector2f maxPos = minPos;
+  for (auto& body : m_bodies) {
+    minPos.x = std::min(minPos.x, body.position.x);
+    minPos.y = std::min(minPos.y, body.position.y);
+    maxPos.x = std::max(maxPos.x, body.position.x);
+    maxPos.y = std::max(maxPos.y, body.position.y);
+  }
+  float size = std::max(std::max(maxPos.x - minPos.x, maxPos.y - minPos.y), 1.f);
+
+  Node root;
+  root.bounds = sf::FloatRect(minPos, {size, size});
+  root.bodyEnd = m_bodies.size();
+  m_nodes.push_back(root);
+  subdivide(0, 0);
+}
+
+void BarnesHutTree::subdivide(size_t nodeIndex, int depth) {
+  aggregate(m_nodes[nodeIndex]);
+  Node node = m_nodes[nodeIndex];
+  if (node.bodyEnd - node.bodyBegin <= 1 || depth >= MaxDepth) {
+    return;
+  }
+
+  // partition bodies into quadrants: first by y, then both halves by x
+  const float halfSize = node.bounds.width / 2;
+  const float midX = node.bounds.left + halfSize;
+  const float midY = node.bounds.top + halfSize;
+  auto begin = m_bodies.begin() + node.bodyBegin;
+  auto end = m_bodies.begin() + node.bodyEnd;
+  auto splitY = std::partition(begin, end, [=](const Body& b) { return b.position.y < midY; });
+  auto splitTop = std::partition(begin, splitY, [=](const Body& b) { return b.position.x < midX; });
+  auto splitBottom = std::partition(splitY, end, [=](const Body& b) { return b.position.x < midX; });
+
+  const size_t bounds[5] = {
+      node.bodyBegin,
+      static_cast<size_t>(splitTop - m_bodies.begin()),
+      static_cast<size_t>(splitY - m_bodies.begin()),
+      static_cast<size_t>(splitBottom - m_bodies.begin()),
+      node.bodyEnd,
+  };
+
+  const size_t firstChild = m_nodes.size();
+  m_nodes[nodeIndex].firstChild = static_cast<int>(firstChild);
+  for (int quadrant = 0; quadrant < 4; ++quadrant) {
+    Node child;
+    child.bounds = sf::FloatRect(node.bounds.left + (quadrant % 2) * halfSize,
+                                 node.bounds.top + (quadrant / 2) * halfSize,
+                                 halfSize,
+                                 halfSize);
+    child.bodyBegin = bounds[quadrant];
+    child.bodyEnd = bounds[quadrant + 1];
+    m_nodes.push_back(child);
+  }
+  // m_nodes might be reallocated by the recursive calls, hence use indices only
+  for (size_t child = firstChild; child < firstChild + 4; ++child) {
+    subdivide(child, depth + 1);
+  }
+}
+
+void BarnesHutTree::aggregate(Node& node) const {
+  float weightSum = 0;
+  sf::Vector2f weightedCenter;
+  for (size_t i = node.bodyBegin; i < node.bodyEnd; ++i) {
+    const Body& body = m_bodies[i];
+    float weight = std::abs(body.intensity);
+    weightedCenter += body.position * weight;
+    weightSum += weight;
+    node.intensity += body.intensity;
+    node.maxRadius = std::max(node.maxRadius, body.radius);
+  }
+  if (weightSum > 0) {
+    node.center = weightedCenter / weightSum;
+  } else {
+    node.center = {node.bounds.left + node.bounds.width / 2, node.bounds.top + node.bounds.height / 2};
+  }
+}
+
+sf::Vector2f BarnesHutTree::force(const sf::Vector2f& position, float intensity,
+                                  float openingAngle) const {
+  sf::Vector2f totalForce;
+  if (m_nodes.empty()) {
+    return totalForce;
+  }
+  const float openingAngleSq = openingAngle * openingAngle;
+  size_t stack[4 * MaxDepth + 1];
+  size_t stackSize = 0;
+  stack[stackSize++] = 0;
+  while (stackSize > 0) {
+    const Node& node = m_nodes[stack[--stackSize]];
+    if (node.bodyBegin == node.bodyEnd) {
+      continue;
+    }
+    if (node.firstChild >= 0) {
+      sf::Vector2f delta = node.center - position;
+      float distanceSq = math::vector::lengthSquared(delta);
+      // only approximate when far away and outside of every attractor's radius
+      sf::FloatRect inflated(node.bounds.left - node.maxRadius,
+                             node.bounds.top - node.maxRadius,
+                             node.bounds.width + 2 * node.maxRadius,
+                             node.bounds.height + 2 * node.maxRadius);
+      if (node.bounds.width * node.bounds.width < openingAngleSq * distanceSq &&
+          !inflated.contains(position)) {
+        totalForce += delta / static_cast<float>(std::sqrt(distanceSq)) * intensity *
+                      node.intensity / distanceSq;
+      } else {
+        for (int child = 0; child < 4; ++child) {
+          stack[stackSize++] = static_cast<size_t>(node.firstChild + child);
+        }
+      }
+    } else {
+      for (size_t i = node.bodyBegin; i < node.bodyEnd; ++i) {
+        const Body& body = m_bodies[i];
+        totalForce +=
+            attractionForce(body.position - position, intensity * body.intensity, body.radius);
+      }
+    }
+  }
+  return totalForce;
+}
+
+}
+}
+}
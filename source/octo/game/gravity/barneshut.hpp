@@ -0,0 +1,103 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace gravity {
+
+/*! \brief A quadtree approximating the attraction exerted by a set of attractors.
+ *
+ *  Every inner node stores the sum of the intensities of the attractors below it and
+ *  their intensity-weighted center. When a node is far enough away from the point of
+ *  interest, it is treated as a single point attractor, reducing the cost of evaluating
+ *  the force from \f$ O(n) \f$ to \f$ O(\log n) \f$ for \f$ n \f$ attractors.
+ *
+ *  Attractors that are evaluated individually use the exact falloff, including the
+ *  approximation inside of the attractor's radius.
+ *
+ *  \remark The approximation assumes that all attractors in a tree have intensities with the
+ *  same sign. Mixing attractors and repellers still works, but degrades the accuracy.
+ */
+class BarnesHutTree {
+public:
+  /// A single attractor stored in the tree.
+  struct Body {
+    /// position of the attractor
+    sf::Vector2f position;
+    /// intensity of the attractor
+    float intensity;
+    /// radius of the attractor
+    float radius;
+  };
+
+  /*! \brief Removes all attractors from the tree.
+   */
+  void clear();
+
+  /*! \brief Adds an attractor.
+   *
+   *  The tree is only updated when calling \ref build.
+   *
+   *  \param body the attractor to be added.
+   */
+  void insert(const Body& body);
+
+  /*! \brief Rebuilds the tree from the attractors inserted since the last \ref clear.
+   */
+  void build();
+
+  /*! \brief Checks whether the tree contains any attractors.
+   */
+  bool empty() const;
+
+  /*! \brief Computes the force acting on an attractable.
+   *
+   *  \param position the position of the attractable.
+   *  \param intensity the intensity of the attractable.
+   *  \param openingAngle the ratio of node size and distance below which a node is approximated
+   *  as a whole. A value of zero evaluates all attractors individually.
+   *  \returns the approximated force acting on the attractable.
+   */
+  sf::Vector2f force(const sf::Vector2f& position, float intensity, float openingAngle) const;
+
+private:
+  struct Node {
+    /// the square region covered by this node
+    sf::FloatRect bounds;
+    /// the intensity-weighted center of all attractors in this node
+    sf::Vector2f center;
+    /// the sum of all intensities in this node
+    float intensity = 0;
+    /// the largest attractor radius in this node
+    float maxRadius = 0;
+    /// the index of the first of four children, or -1 for leaves
+    int firstChild = -1;
+    /// the range of bodies in \ref BarnesHutTree::m_bodies belonging to this node
+    size_t bodyBegin = 0;
+    size_t bodyEnd = 0;
+  };
+
+  /*! \brief Recursively subdivides a node until it contains at most one attractor.
+   *  \param nodeIndex the node to be subdivided.
+   *  \param depth the depth of the node, used for limiting subdivision of coincident attractors.
+   */
+  void subdivide(size_t nodeIndex, int depth);
+
+  /// Aggregates the attractors of a node into its center and intensity.
+  void aggregate(Node& node) const;
+
+  /// the maximum depth of the tree
+  static constexpr int MaxDepth = 24;
+
+  std::vector<Body> m_bodies;
+  std::vector<Node> m_nodes;
+};
+
+}
+}
+}
@@ -0,0 +1,59 @@
+#include "fieldgrid.hpp"
+
+#include "force.hpp"
+
+#include <cmath>
+
+namespace octo {
+namespace game {
+namespace gravity {
+
+void FieldGrid::reset(float radius, float cellSize) {
+  m_cellSize = cellSize;
+  m_inverseCellSize = 1 / cellSize;
+  m_samples = static_cast<size_t>(std::ceil(2 * radius * m_inverseCellSize)) + 1;
+  m_origin = {-radius, -radius};
+  m_field.assign(m_samples * m_samples, sf::Vector2f());
+}
+
+bool FieldGrid::empty() const {
+  return m_field.empty();
+}
+
+void FieldGrid::add(const sf::Vector2f& position, float intensity, float radius) {
+  for (size_t y = 0; y < m_samples; ++y) {
+    for (size_t x = 0; x < m_samples; ++x) {
+      sf::Vector2f samplePos = m_origin + sf::Vector2f(x * m_cellSize, y * m_cellSize);
+      sf::Vector2f delta = position - samplePos;
+      // the force vanishes in the center of the attractor
+      if (delta.x != 0 || delta.y != 0) {
+        m_field[y * m_samples + x] += attractionForce(delta, intensity, radius);
+      }
+    }
+  }
+}
+
+bool FieldGrid::contains(const sf::Vector2f& position) const {
+  float gx = (position.x - m_origin.x) * m_inverseCellSize;
+  float gy = (position.y - m_origin.y) * m_inverseCellSize;
+  float last = static_cast<float>(m_samples) - 1;
+  return m_samples > 1 && gx >= 0 && gy >= 0 && gx < last && gy < last;
+}
+
+sf::Vector2f FieldGrid::sample(const sf::Vector2f& position) const {
+  float gx = (position.x - m_origin.x) * m_inverseCellSize;
+  float gy = (position.y - m_origin.y) * m_inverseCellSize;
+  float fx = std::floor(gx);
+  float fy = std::floor(gy);
+  size_t index = static_cast<size_t>(fy) * m_samples + static_cast<size_t>(fx);
+  float tx = gx - fx;
+  float ty = gy - fy;
+
+  sf::Vector2f top = m_field[index] * (1 - tx) + m_field[index + 1] * tx;
+  sf::Vector2f bottom = m_field[index + m_samples] * (1 - tx) + m_field[index + m_samples + 1] * tx;
+  return top * (1 - ty) + bottom * ty;
+}
+
+}
+}
+}
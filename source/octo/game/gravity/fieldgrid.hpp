@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace gravity {
+
+/*! \brief A precomputed grid of attractive forces around the origin.
+ *
+ *  The grid stores the force that would act on an attractable with unit intensity
+ *  at regularly spaced sample points. In between, the force is bilinearly interpolated.
+ *  This is only sensible for attractors that never move.
+ */
+class FieldGrid {
+public:
+  /*! \brief Discards all attractors and resizes the grid.
+   *
+   *  \param radius the grid covers the square from \c -radius to \c radius on both axes.
+   *  \param cellSize the distance between two neighboring sample points.
+   */
+  void reset(float radius, float cellSize);
+
+  /*! \brief Checks whether the grid has been initialized by \ref reset.
+   */
+  bool empty() const;
+
+  /*! \brief Adds the force of an attractor to all sample points.
+   *
+   *  \param position the position of the attractor
+   *  \param intensity the intensity of the attractor
+   *  \param radius the radius of the attractor
+   */
+  void add(const sf::Vector2f& position, float intensity, float radius);
+
+  /*! \brief Checks whether the grid covers a point.
+   *  \param position the point of interest
+   *  \returns \c true if \ref sample can be called for \p position.
+   */
+  bool contains(const sf::Vector2f& position) const;
+
+  /*! \brief Interpolates the force acting on an attractable with unit intensity.
+   *  \param position a point covered by the grid, see \ref contains.
+   *  \returns the interpolated force at \p position.
+   */
+  sf::Vector2f sample(const sf::Vector2f& position) const;
+
+private:
+  /// the world position of the first sample point
+  sf::Vector2f m_origin;
+  float m_cellSize = 1;
+  float m_inverseCellSize = 1;
+  /// the number of sample points along each axis
+  size_t m_samples = 0;
+  /// the forces at the sample points in row-major order
+  std::vector<sf::Vector2f> m_field;
+};
+
+}
+}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cmath>
+
+namespace octo {
+namespace game {
+namespace gravity {
+
+/*! \brief Computes the attractive force exerted on an attractable by a single attractor.
+ *
+ *  This is the falloff documented at \ref systems::Attraction: outside of \p radius,
+ *  the force decreases quadratically with distance, inside of it the force
+ *  is scaled down towards the center using the \f$ \alpha \f$ approximation.
+ *
+ *  \param delta the vector pointing from the attractable to the attractor.
+ *  \param intensity the product of the intensities of attractor and attractable.
+ *  \param radius the radius of the attractor.
+ *  \returns the force acting on the attractable.
+ */
+inline sf::Vector2f attractionForce(const sf::Vector2f& delta, float intensity, float radius) {
+  float distanceSq = delta.x * delta.x + delta.y * delta.y;
+  float distance = static_cast<float>(std::sqrt(distanceSq));
+  float radiusSq = radius * radius;
+
+  sf::Vector2f force = delta / distance * intensity;
+  if (__builtin_expect(distanceSq < radiusSq, 0)) {
+    // when inside the attractor, reduce force towards center based on an approximation
+    // computed from the ratio of the two parts pulling the object further inwards,
+    // and pulling it outwards.
+    float alpha = distance * (3 * radiusSq - distanceSq) / (2 * radiusSq * radius);
+    force *= alpha / radiusSq;
+  } else {
+    force /= distanceSq;
+  }
+  return force;
+}
+
+}
+}
+}
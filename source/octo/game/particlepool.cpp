@@ -0,0 +1,44 @@
+#include "particlepool.hpp"
+
+#include <cassert>
+
+using namespace octo::game;
+
+ParticlePool::ParticlePool(size_t capacity)
+    : m_x(capacity), m_y(capacity), m_vx(capacity), m_vy(capacity), m_lifetime(capacity) {}
+
+size_t ParticlePool::capacity() const {
+  return m_x.size();
+}
+
+size_t ParticlePool::size() const {
+  return m_size;
+}
+
+bool ParticlePool::spawn(const sf::Vector2f& position, const sf::Vector2f& velocity,
+                         float lifetime) {
+  if (m_size == capacity()) {
+    return false;
+  }
+  m_x[m_size] = position.x;
+  m_y[m_size] = position.y;
+  m_vx[m_size] = velocity.x;
+  m_vy[m_size] = velocity.y;
+  m_lifetime[m_size] = lifetime;
+  ++m_size;
+  return true;
+}
+
+void ParticlePool::remove(size_t index) {
+  assert(index < m_size);
+  --m_size;
+  m_x[index] = m_x[m_size];
+  m_y[index] = m_y[m_size];
+  m_vx[index] = m_vx[m_size];
+  m_vy[index] = m_vy[m_size];
+  m_lifetime[index] = m_lifetime[m_size];
+}
+
+void ParticlePool::clear() {
+  m_size = 0;
+}
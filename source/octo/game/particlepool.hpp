@@ -0,0 +1,78 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace octo {
+namespace game {
+
+/*! \brief A fixed number of point particles, stored as structure of arrays.
+ *
+ *  Particles like debris are far too numerous for being entities. Their storage is allocated
+ *  once, spawning and removing particles never allocates. Live particles occupy the indices
+ *  \c [0,size()), removing one moves the last particle into its place, hence the order of
+ *  particles is not preserved.
+ */
+class ParticlePool {
+public:
+  /*! \brief Allocates the storage for a number of particles.
+   *  \param capacity the maximum number of live particles.
+   */
+  explicit ParticlePool(size_t capacity);
+
+  /// the maximum number of live particles
+  size_t capacity() const;
+
+  /// the number of live particles
+  size_t size() const;
+
+  /*! \brief Adds a particle, unless the pool is full.
+   *
+   *  \param position the position in world coordinates.
+   *  \param velocity the velocity in world units per second.
+   *  \param lifetime the number of seconds after which the particle vanishes.
+   *  \returns whether the particle was added.
+   */
+  bool spawn(const sf::Vector2f& position, const sf::Vector2f& velocity, float lifetime);
+
+  /*! \brief Removes a particle by moving the last particle into its place.
+   *  \param index the index of a live particle.
+   */
+  void remove(size_t index);
+
+  /// Removes all particles.
+  void clear();
+
+  /// the x coordinates of the particles
+  float* x() { return m_x.data(); }
+  const float* x() const { return m_x.data(); }
+
+  /// the y coordinates of the particles
+  float* y() { return m_y.data(); }
+  const float* y() const { return m_y.data(); }
+
+  /// the x components of the velocities
+  float* vx() { return m_vx.data(); }
+  const float* vx() const { return m_vx.data(); }
+
+  /// the y components of the velocities
+  float* vy() { return m_vy.data(); }
+  const float* vy() const { return m_vy.data(); }
+
+  /// the remaining lifetimes in seconds
+  float* lifetime() { return m_lifetime.data(); }
+  const float* lifetime() const { return m_lifetime.data(); }
+
+private:
+  size_t m_size = 0;
+  std::vector<float> m_x;
+  std::vector<float> m_y;
+  std::vector<float> m_vx;
+  std::vector<float> m_vy;
+  std::vector<float> m_lifetime;
+};
+
+}
+}
@@ -0,0 +1,78 @@
+#include "scenario.hpp"
+#include "world.hpp"
+
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace octo::game;
+
+namespace {
+
+struct Circle {
+  sf::Vector2f center;
+  float radius;
+};
+
+bool overlaps(const std::vector<Circle>& circles, sf::Vector2f center, float radius) {
+  for (const auto& c : circles) {
+    sf::Vector2f d = c.center - center;
+    float r = c.radius + radius;
+    if (d.x * d.x + d.y * d.y < r * r) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}
+
+void octo::game::populate(World& world, const Scenario& scenario) {
+  const float twoPi = boost::math::constants::two_pi<float>();
+  // a bounded number of attempts for finding a free spot, afterwards overlaps are accepted
+  const int maxAttempts = 32;
+
+  std::mt19937 rng(scenario.seed);
+  std::uniform_real_distribution<float> unit(0, 1);
+  std::uniform_real_distribution<float> angle(0, twoPi);
+
+  auto randomPosition = [&](float margin) {
+    float r = std::sqrt(unit(rng)) * std::max(0.f, scenario.radius - margin);
+    float a = angle(rng);
+    return sf::Vector2f(std::cos(a) * r, std::sin(a) * r);
+  };
+  auto freePosition = [&](const std::vector<Circle>& occupied, float radius) {
+    sf::Vector2f pos = randomPosition(radius);
+    for (int attempt = 1; attempt < maxAttempts && overlaps(occupied, pos, radius); ++attempt) {
+      pos = randomPosition(radius);
+    }
+    return pos;
+  };
+
+  std::vector<Circle> occupied;
+  std::uniform_int_distribution<int> planetRadius(22, 128);
+  for (size_t i = 0; i < scenario.planets; ++i) {
+    int radius = planetRadius(rng);
+    sf::Vector2f pos = freePosition(occupied, radius);
+    // keep the surface gravity comparable to the planets of the default level
+    float mass = 30000.f * radius * radius / (128.f * 128.f);
+    world.addPlanet(pos, radius, mass);
+    occupied.push_back({ pos, static_cast<float>(radius) });
+  }
+
+  std::uniform_real_distribution<float> speed(0, 150);
+  for (size_t i = 0; i < scenario.bullets; ++i) {
+    sf::Vector2f pos = freePosition(occupied, 4);
+    float a = angle(rng);
+    world.spawnDebugBullet(pos, sf::Vector2f(std::cos(a), std::sin(a)) * speed(rng));
+  }
+
+  for (size_t i = 0; i < scenario.vessels; ++i) {
+    sf::Vector2f pos = freePosition(occupied, 32);
+    world.spawnVessel(pos, angle(rng) * 360 / twoPi);
+    occupied.push_back({ pos, 32 });
+  }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace octo {
+namespace game {
+
+class World;
+
+/*! \brief Describes a randomly generated world, e.g. for benchmarking.
+ *
+ *  Identical scenarios always produce identical worlds.
+ */
+struct Scenario {
+  /// the number of planets
+  size_t planets = 3;
+  /// the number of bullets
+  size_t bullets = 100;
+  /// the number of vessels
+  size_t vessels = 1;
+  /// the seed of the random number generator used for placing the entities
+  uint32_t seed = 0;
+  /// the radius of the region the entities are placed in
+  float radius = 800;
+};
+
+/*! \brief Adds the entities described by a scenario to a world.
+ *
+ *  Planets are placed first, such that they do not overlap each other if possible.
+ *  Bullets and vessels are placed in the remaining free space with a random velocity.
+ */
+void populate(World& world, const Scenario& scenario);
+
+}
+}
@@ -0,0 +1,177 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+using namespace octo::game;
+
+SystemAccess& SystemAccess::changesEntities() {
+  m_changesEntities = true;
+  return *this;
+}
+
+SystemAccess& SystemAccess::mainThread() {
+  m_mainThread = true;
+  return *this;
+}
+
+bool SystemAccess::changesEntityStructure() const {
+  return m_changesEntities;
+}
+
+bool SystemAccess::requiresMainThread() const {
+  return m_mainThread;
+}
+
+bool SystemAccess::conflicts(const SystemAccess& other) const {
+  // every system depends on the entity structure
+  if (m_changesEntities || other.m_changesEntities) {
+    return true;
+  }
+  return intersects(m_writes, other.m_writes) || intersects(m_writes, other.m_reads) ||
+         intersects(m_reads, other.m_writes);
+}
+
+void SystemAccess::add(std::vector<std::type_index>& set,
+                       std::initializer_list<std::type_index> types) {
+  set.insert(set.end(), types);
+  std::sort(set.begin(), set.end());
+  set.erase(std::unique(set.begin(), set.end()), set.end());
+}
+
+bool SystemAccess::intersects(const std::vector<std::type_index>& a,
+                              const std::vector<std::type_index>& b) {
+  // both sets are sorted
+  auto ia = a.begin();
+  auto ib = b.begin();
+  while (ia != a.end() && ib != b.end()) {
+    if (*ia < *ib) {
+      ++ia;
+    } else if (*ib < *ia) {
+      ++ib;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+SystemScheduler::SystemScheduler(size_t threads) {
+  setThreadCount(threads);
+}
+
+size_t SystemScheduler::add(std::type_index type, Update update, SystemAccess access) {
+  m_nodes.push_back(Node{type, std::move(update), std::move(access)});
+  m_stagesDirty = true;
+  return m_nodes.size() - 1;
+}
+
+void SystemScheduler::addDependency(std::type_index system, std::type_index dependency) {
+  m_dependencies.emplace_back(system, dependency);
+  m_stagesDirty = true;
+}
+
+void SystemScheduler::run(entityx::TimeDelta dt, Statistics& statistics) {
+  for (const auto& stage : stages()) {
+    if (stage.size() == 1 || m_threads->size() == 0) {
+      for (size_t index : stage) {
+        runSystem(index, dt, statistics);
+      }
+      continue;
+    }
+    for (size_t index : stage) {
+      if (!m_nodes[index].access.requiresMainThread()) {
+        m_threads->submit([this, index, dt, &statistics]() { runSystem(index, dt, statistics); });
+      }
+    }
+    for (size_t index : stage) {
+      if (m_nodes[index].access.requiresMainThread()) {
+        runSystem(index, dt, statistics);
+      }
+    }
+    m_threads->wait();
+  }
+}
+
+size_t SystemScheduler::threadCount() const {
+  return m_threads->size();
+}
+
+void SystemScheduler::setThreadCount(size_t threads) {
+  if (!m_threads || m_threads->size() != threads) {
+    m_threads.reset(new util::ThreadPool(threads));
+  }
+}
+
+const std::vector<std::vector<size_t>>& SystemScheduler::stages() {
+  if (m_stagesDirty) {
+    buildStages();
+    m_stagesDirty = false;
+  }
+  return m_stages;
+}
+
+void SystemScheduler::buildStages() {
+  size_t count = m_nodes.size();
+  std::vector<std::vector<size_t>> successors(count);
+  std::vector<size_t> predecessors(count, 0);
+  auto addEdge = [&](size_t from, size_t to) {
+    successors[from].push_back(to);
+    predecessors[to] += 1;
+  };
+  // conflicting systems keep the order they were added in
+  for (size_t a = 0; a < count; ++a) {
+    for (size_t b = a + 1; b < count; ++b) {
+      if (m_nodes[a].access.conflicts(m_nodes[b].access)) {
+        addEdge(a, b);
+      }
+    }
+  }
+  auto find = [this](std::type_index type) {
+    return std::find_if(m_nodes.begin(), m_nodes.end(),
+                        [type](const Node& node) { return node.type == type; });
+  };
+  for (const auto& dependency : m_dependencies) {
+    auto system = find(dependency.first);
+    auto before = find(dependency.second);
+    if (system != m_nodes.end() && before != m_nodes.end()) {
+      addEdge(before - m_nodes.begin(), system - m_nodes.begin());
+    }
+  }
+
+  // every system is placed in the stage after its latest predecessor
+  m_stages.clear();
+  std::vector<size_t> ready;
+  for (size_t i = 0; i < count; ++i) {
+    if (predecessors[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  size_t placed = 0;
+  while (!ready.empty()) {
+    m_stages.push_back(ready);
+    placed += ready.size();
+    std::vector<size_t> next;
+    for (size_t index : ready) {
+      for (size_t successor : successors[index]) {
+        predecessors[successor] -= 1;
+        if (predecessors[successor] == 0) {
+          next.push_back(successor);
+        }
+      }
+    }
+    std::sort(next.begin(), next.end());
+    ready = std::move(next);
+  }
+  if (placed != count) {
+    throw std::logic_error("cyclic system dependencies");
+  }
+}
+
+void SystemScheduler::runSystem(size_t index, entityx::TimeDelta dt, Statistics& statistics) {
+  auto start = std::chrono::steady_clock::now();
+  m_nodes[index].update(dt);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  statistics.recordTiming(index, elapsed.count());
+}
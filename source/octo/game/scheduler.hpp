@@ -0,0 +1,166 @@
+#pragma once
+
+#include "statistics.hpp"
+#include <octo/util/threadpool.hpp>
+
+#include <entityx/entityx.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+namespace octo {
+namespace game {
+
+/*! \brief Declares which shared data a system accesses during its update.
+ *
+ *  Components and events are identified by their type. Receiving an event counts as
+ *  reading it, since the receiver's handler runs on the emitting thread, and emitting an
+ *  event counts as writing it. Creating or destroying entities, as well as adding or removing
+ *  components, changes the entity structure every other system depends on.
+ */
+class SystemAccess {
+public:
+  /// Declares read access to components or events.
+  template <typename... Ts>
+  SystemAccess& reads() {
+    add(m_reads, {std::type_index(typeid(Ts))...});
+    return *this;
+  }
+
+  /// Declares write access to components or events.
+  template <typename... Ts>
+  SystemAccess& writes() {
+    add(m_writes, {std::type_index(typeid(Ts))...});
+    return *this;
+  }
+
+  /// Declares that events are received, i.e. the receiver's state is written on emission.
+  template <typename... Es>
+  SystemAccess& receives() {
+    return reads<Es...>();
+  }
+
+  /// Declares that events are emitted.
+  template <typename... Es>
+  SystemAccess& emits() {
+    return writes<Es...>();
+  }
+
+  /// Declares that entities are created or destroyed, or components are added or removed.
+  SystemAccess& changesEntities();
+
+  /// Declares that the system must run on the thread calling SystemScheduler::run.
+  SystemAccess& mainThread();
+
+  /// whether the system changes the entity structure
+  bool changesEntityStructure() const;
+
+  /// whether the system must run on the thread calling SystemScheduler::run
+  bool requiresMainThread() const;
+
+  /// Checks whether two systems must not run at the same time.
+  bool conflicts(const SystemAccess& other) const;
+
+private:
+  static void add(std::vector<std::type_index>& set, std::initializer_list<std::type_index> types);
+
+  static bool intersects(const std::vector<std::type_index>& a,
+                         const std::vector<std::type_index>& b);
+
+private:
+  std::vector<std::type_index> m_reads;
+  std::vector<std::type_index> m_writes;
+  bool m_changesEntities = false;
+  bool m_mainThread = false;
+};
+
+/*! \brief Runs systems in parallel where their declared accesses allow it.
+ *
+ *  The order of two systems is fixed if they conflict or if one was declared to depend on
+ *  the other. Conflicting systems without a declared dependency run in the order they were
+ *  added. All other systems may run at the same time on a worker pool.
+ *
+ *  A step is executed in stages: every stage contains the systems whose predecessors are all
+ *  in earlier stages, and the stages run one after another.
+ */
+class SystemScheduler {
+public:
+  /// Updates a system for a time step.
+  typedef std::function<void(entityx::TimeDelta)> Update;
+
+  /*! \brief Creates a scheduler.
+   *  \param threads the number of worker threads, with zero threads every system runs on
+   *  the calling thread.
+   */
+  explicit SystemScheduler(size_t threads = 0);
+
+  /*! \brief Adds a system.
+   *
+   *  \param type identifies the system in dependencies.
+   *  \param update runs the system's update.
+   *  \param access the data accessed by the system.
+   *  \returns the index of the system, which is also its index in the statistics timings.
+   */
+  size_t add(std::type_index type, Update update, SystemAccess access);
+
+  /*! \brief Declares that system \c S must run after system \c Dependency.
+   *
+   *  Dependencies referring to systems that were not added are ignored.
+   */
+  template <class S, class Dependency>
+  void addDependency() {
+    addDependency(typeid(S), typeid(Dependency));
+  }
+
+  /// \copydoc addDependency()
+  void addDependency(std::type_index system, std::type_index dependency);
+
+  /*! \brief Runs all systems once.
+   *
+   *  \param dt the time step passed to the systems.
+   *  \param statistics receives the duration of every system's update.
+   *  \throws std::logic_error if the dependencies are cyclic.
+   */
+  void run(entityx::TimeDelta dt, Statistics& statistics);
+
+  /// the number of worker threads
+  size_t threadCount() const;
+
+  /// sets the number of worker threads
+  void setThreadCount(size_t threads);
+
+  /*! \brief The stages of the last computed schedule.
+   *
+   *  Each stage lists the indices of the systems running in parallel.
+   */
+  const std::vector<std::vector<size_t>>& stages();
+
+private:
+  struct Node {
+    std::type_index type;
+    Update update;
+    SystemAccess access;
+  };
+
+  /// Recomputes \ref m_stages from the systems, their accesses and dependencies.
+  void buildStages();
+
+  /// Runs a single system and records its duration.
+  void runSystem(size_t index, entityx::TimeDelta dt, Statistics& statistics);
+
+private:
+  std::vector<Node> m_nodes;
+  /// explicit dependencies as (system, dependency) pairs
+  std::vector<std::pair<std::type_index, std::type_index>> m_dependencies;
+  std::vector<std::vector<size_t>> m_stages;
+  bool m_stagesDirty = true;
+  std::unique_ptr<util::ThreadPool> m_threads;
+};
+
+}
+}
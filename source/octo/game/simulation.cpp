@@ -0,0 +1,156 @@
+#include "simulation.hpp"
+
+#include <algorithm>
+
+using namespace octo::game;
+
+Simulation::Simulation(std::unique_ptr<World> world, float timeStep)
+    : m_world(std::move(world)), m_timeStep(timeStep) {
+  m_back = std::make_shared<WorldSnapshot>();
+  publish();
+  m_thread = std::thread([this]() { run(); });
+}
+
+Simulation::~Simulation() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wakeUp.notify_all();
+  m_thread.join();
+}
+
+std::shared_ptr<const WorldSnapshot> Simulation::latest() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_latest;
+}
+
+void Simulation::release(std::shared_ptr<const WorldSnapshot> snapshot) {
+  if (!snapshot) {
+    return;
+  }
+  // snapshots are only handed out const, the buffers themselves are owned by the simulation
+  std::shared_ptr<WorldSnapshot> buffer = std::const_pointer_cast<WorldSnapshot>(snapshot);
+  snapshot.reset();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (buffer != m_latest) {
+    std::swap(buffer, m_released);
+  }
+}
+
+float Simulation::interpolationAlpha(const WorldSnapshot& snapshot) const {
+  if (m_paused) {
+    return 1;
+  }
+  std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - snapshot.time;
+  float alpha = elapsed.count() * m_timeFactor / m_timeStep;
+  return std::min(std::max(alpha, 0.f), 1.f);
+}
+
+void Simulation::post(std::function<void(World&)> command) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_commands.push_back(std::move(command));
+  }
+  m_wakeUp.notify_all();
+}
+
+bool Simulation::paused() const {
+  return m_paused;
+}
+
+void Simulation::setPaused(bool paused) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paused = paused;
+  }
+  m_wakeUp.notify_all();
+}
+
+float Simulation::timeFactor() const {
+  return m_timeFactor;
+}
+
+void Simulation::setTimeFactor(float factor) {
+  m_timeFactor = factor;
+}
+
+void Simulation::run() {
+  using Clock = std::chrono::steady_clock;
+  log.info("simulation thread started");
+  double accumulator = 0;
+  Clock::time_point last = Clock::now();
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_paused) {
+        m_wakeUp.wait(lock, [this]() { return m_stopping || !m_paused || !m_commands.empty(); });
+        // time spent paused does not count
+        last = Clock::now();
+        accumulator = 0;
+      }
+      if (m_stopping) {
+        break;
+      }
+    }
+    bool changed = runCommands();
+
+    Clock::time_point now = Clock::now();
+    std::chrono::duration<double> elapsed = now - last;
+    last = now;
+    if (!m_paused) {
+      accumulator += elapsed.count() * m_timeFactor;
+    }
+    int steps = 0;
+    while (accumulator >= m_timeStep && steps < m_maxStepsPerIteration) {
+      m_world->update(m_timeStep);
+      accumulator -= m_timeStep;
+      steps += 1;
+      publish();
+    }
+    if (steps == m_maxStepsPerIteration) {
+      // the simulation cannot keep up, slow it down instead of spiralling
+      accumulator = 0;
+    }
+    if (steps == 0 && changed) {
+      // make the effects of commands visible while paused
+      publish();
+    }
+
+    // sleep until the next step is due
+    float factor = m_timeFactor;
+    if (!m_paused && factor > 0) {
+      std::chrono::duration<double> wait((m_timeStep - accumulator) / factor);
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeUp.wait_for(lock, wait, [this]() { return m_stopping || !m_commands.empty(); });
+    }
+  }
+  log.info("simulation thread stopped");
+}
+
+void Simulation::publish() {
+  m_back->capture(*m_world);
+  std::shared_ptr<WorldSnapshot> previous;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    previous = std::move(m_latest);
+    m_latest = std::move(m_back);
+    // only a snapshot the render thread has handed back is safe to overwrite
+    m_back = std::move(m_released);
+  }
+  if (!m_back) {
+    m_back = std::make_shared<WorldSnapshot>();
+  }
+}
+
+bool Simulation::runCommands() {
+  std::vector<std::function<void(World&)>> commands;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::swap(commands, m_commands);
+  }
+  for (auto& command : commands) {
+    command(*m_world);
+  }
+  return !commands.empty();
+}
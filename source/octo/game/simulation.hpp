@@ -0,0 +1,116 @@
+#pragma once
+
+#include "snapshot.hpp"
+#include "world.hpp"
+
+#include <fmtlog/fmtlog.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace octo {
+namespace game {
+
+/*! \brief Runs the fixed time steps of a world on a dedicated thread.
+ *
+ *  The simulation paces itself in real time, independent of the frame rate. After each
+ *  step, it publishes a WorldSnapshot, so the render thread never touches the world.
+ *  Snapshots are recycled: the render thread hands back the ones it has finished reading,
+ *  and a new buffer is only allocated when none was handed back since the last step.
+ */
+class Simulation {
+public:
+  /*! \brief Takes ownership of a world and publishes its initial state.
+   *
+   *  The simulation thread is started paused.
+   *  \param world the world to be simulated.
+   *  \param timeStep the duration of a single step in simulated seconds.
+   */
+  Simulation(std::unique_ptr<World> world, float timeStep);
+
+  /// Stops the simulation thread.
+  ~Simulation();
+
+  Simulation(const Simulation&) = delete;
+  Simulation& operator=(const Simulation&) = delete;
+
+  /// the most recently published snapshot
+  std::shared_ptr<const WorldSnapshot> latest() const;
+
+  /*! \brief Hands a snapshot back to be overwritten by a later step.
+   *
+   *  The caller must not keep any other reference to the snapshot. Handing back the latest
+   *  snapshot has no effect.
+   */
+  void release(std::shared_ptr<const WorldSnapshot> snapshot);
+
+  /*! \brief Computes the blend factor for rendering a snapshot at the current time.
+   *
+   *  \returns the fraction of the next step that has elapsed since the snapshot was taken,
+   *  clamped to <tt>[0, 1]</tt>.
+   */
+  float interpolationAlpha(const WorldSnapshot& snapshot) const;
+
+  /*! \brief Runs a function on the simulation thread between two steps.
+   *
+   *  This is the only way to modify the world after the simulation has been started.
+   */
+  void post(std::function<void(World&)> command);
+
+  /// whether the simulation is paused
+  bool paused() const;
+
+  /// pauses or resumes the simulation
+  void setPaused(bool paused);
+
+  /// the number of simulated seconds per real second
+  float timeFactor() const;
+
+  /// sets the number of simulated seconds per real second
+  void setTimeFactor(float factor);
+
+private:
+  /// The main loop of the simulation thread.
+  void run();
+
+  /// Captures the state of the world and makes it the latest snapshot.
+  void publish();
+
+  /*! \brief Executes all posted commands.
+   *  \returns whether there were any commands.
+   */
+  bool runCommands();
+
+private:
+  fmtlog::Log log = fmtlog::For<Simulation>();
+  std::unique_ptr<World> m_world;
+  float m_timeStep;
+  /// the maximum number of steps performed to catch up, before the simulation slows down
+  int m_maxStepsPerIteration = 10;
+
+  std::atomic<bool> m_paused{true};
+  std::atomic<float> m_timeFactor{1};
+  std::atomic<bool> m_stopping{false};
+
+  /// protects \ref m_latest, \ref m_released and \ref m_commands
+  mutable std::mutex m_mutex;
+  /// signalled when commands are posted, the simulation is resumed or stopped
+  std::condition_variable m_wakeUp;
+  std::shared_ptr<WorldSnapshot> m_latest;
+  /// the buffer the next snapshot is captured into, only used by the simulation thread
+  std::shared_ptr<WorldSnapshot> m_back;
+  /// the snapshot last handed back by the render thread
+  std::shared_ptr<WorldSnapshot> m_released;
+  std::vector<std::function<void(World&)>> m_commands;
+
+  std::thread m_thread;
+};
+
+}
+}
@@ -0,0 +1,44 @@
+#include "snapshot.hpp"
+#include "components.hpp"
+#include "world.hpp"
+
+using namespace octo::game;
+
+components::SpatialSnapshot WorldSnapshot::Entity::interpolated(float alpha) const {
+  return components::lerp(previous, current, alpha);
+}
+
+void WorldSnapshot::capture(World& world) {
+  using namespace components;
+  step = world.updateCount();
+  time = std::chrono::steady_clock::now();
+  clipRadius = world.clipRadius();
+  statistics = world.statistics();
+
+  entities.clear();
+  world.entities.each<Spatial>([this](entityx::Entity entity, Spatial& spatial) {
+    Entity snapshot;
+    snapshot.id = entity.id();
+    snapshot.previous = spatial.previous();
+    snapshot.current = spatial.current();
+    snapshot.planet = entity.has_component<Planet>();
+    auto body = entity.component<DynamicBody>();
+    if (body) {
+      snapshot.hasBody = true;
+      snapshot.velocity = body->velocity();
+    }
+    auto mask = entity.component<CollisionMask>();
+    auto debugData = entity.component<DebugData>();
+    if (mask && debugData) {
+      snapshot.maskImage = debugData->collisionMaskImage;
+      snapshot.maskAnchor = mask->anchor;
+    }
+    entities.push_back(std::move(snapshot));
+  });
+
+  const ParticlePool& pool = world.particles();
+  particles.resize(pool.size());
+  for (size_t i = 0; i < pool.size(); ++i) {
+    particles[i] = {pool.x()[i], pool.y()[i]};
+  }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "components/debugdata.hpp"
+#include "components/spatial.hpp"
+#include "statistics.hpp"
+
+#include <entityx/entityx.h>
+#include <SFML/System/Vector2.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace octo {
+namespace game {
+
+class World;
+
+/*! \brief An immutable copy of everything needed for rendering a world after a step.
+ *
+ *  Snapshots are produced by the simulation and may be read by the render thread while
+ *  the simulation continues.
+ */
+struct WorldSnapshot {
+  /// The state of a single entity with a spatial component.
+  struct Entity {
+    entityx::Entity::Id id;
+    /// the location before the step
+    components::SpatialSnapshot previous;
+    /// the location after the step
+    components::SpatialSnapshot current;
+    /// whether the entity is a planet
+    bool planet = false;
+    /// whether the entity has a dynamic body
+    bool hasBody = false;
+    /// the velocity of the dynamic body, if any
+    sf::Vector2f velocity;
+    /// the debug image of the collision mask, if any
+    std::shared_ptr<const components::MaskImage> maskImage;
+    /// the anchor of the collision mask
+    sf::Vector2f maskAnchor;
+
+    /*! \brief Interpolates the location between the previous and current step.
+     *  \param alpha the blend factor, where \c 0 is the previous and \c 1 the current location.
+     */
+    components::SpatialSnapshot interpolated(float alpha) const;
+  };
+
+  /// the number of steps the world has been updated before the snapshot
+  size_t step = 0;
+  /// the time the snapshot was taken
+  std::chrono::steady_clock::time_point time;
+  /// the radius outside of which entities are removed
+  float clipRadius = 0;
+  /// all entities with a spatial component
+  std::vector<Entity> entities;
+  /// the positions of all particles
+  std::vector<sf::Vector2f> particles;
+  /// the statistics of the world at the time of the snapshot
+  Statistics statistics;
+
+  /*! \brief Replaces the contents of this snapshot with the state of a world.
+   *
+   *  The world is not modified, the existing storage of the snapshot is reused.
+   */
+  void capture(World& world);
+};
+
+}
+}
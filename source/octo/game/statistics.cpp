@@ -0,0 +1,113 @@
+#include "statistics.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace octo::game;
+
+RollingSeries::RollingSeries(size_t window) : m_window(window) {
+  assert(window > 0);
+  m_values.reserve(window);
+}
+
+void RollingSeries::add(double value) {
+  if (m_values.size() < m_window) {
+    m_values.push_back(value);
+  } else {
+    m_windowSum -= m_values[m_next];
+    m_values[m_next] = value;
+  }
+  m_next = (m_next + 1) % m_window;
+  m_windowSum += value;
+  m_total += value;
+  m_samples += 1;
+}
+
+double RollingSeries::last() const {
+  if (m_values.empty()) {
+    return 0;
+  }
+  return m_values[(m_next + m_window - 1) % m_window];
+}
+
+double RollingSeries::average() const {
+  if (m_values.empty()) {
+    return 0;
+  }
+  return m_windowSum / m_values.size();
+}
+
+double RollingSeries::max() const {
+  if (m_values.empty()) {
+    return 0;
+  }
+  return *std::max_element(m_values.begin(), m_values.end());
+}
+
+double RollingSeries::total() const {
+  return m_total;
+}
+
+size_t RollingSeries::samples() const {
+  return m_samples;
+}
+
+Statistics::Statistics(size_t window) : m_window(window), m_counters(CounterCount, RollingSeries(window)) {}
+
+Statistics::Statistics(const Statistics& other) {
+  *this = other;
+}
+
+Statistics& Statistics::operator=(const Statistics& other) {
+  m_window = other.m_window;
+  m_timings = other.m_timings;
+  m_counters = other.m_counters;
+  for (size_t i = 0; i < CounterCount; ++i) {
+    m_currentCounts[i].store(other.m_currentCounts[i].load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+size_t Statistics::window() const {
+  return m_window;
+}
+
+size_t Statistics::addTiming(std::string name) {
+  m_timings.push_back(Timing{std::move(name), RollingSeries(m_window)});
+  return m_timings.size() - 1;
+}
+
+void Statistics::recordTiming(size_t index, double seconds) {
+  m_timings[index].seconds.add(seconds);
+}
+
+void Statistics::finishStep() {
+  for (size_t i = 0; i < CounterCount; ++i) {
+    m_counters[i].add(static_cast<double>(m_currentCounts[i].exchange(0, std::memory_order_relaxed)));
+  }
+}
+
+const std::vector<Statistics::Timing>& Statistics::timings() const {
+  return m_timings;
+}
+
+const RollingSeries& Statistics::counter(Counter counter) const {
+  return m_counters[static_cast<size_t>(counter)];
+}
+
+const char* Statistics::counterName(Counter counter) {
+  switch (counter) {
+  case Counter::CandidatePairs:
+    return "candidate pairs";
+  case Counter::PixelsTested:
+    return "pixels tested";
+  case Counter::CollisionEvents:
+    return "collisions";
+  case Counter::Explosions:
+    return "explosions";
+  case Counter::Particles:
+    return "particles";
+  }
+  return "unknown";
+}
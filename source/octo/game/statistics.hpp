@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace octo {
+namespace game {
+
+/*! \brief Keeps track of the most recent values of a measurement.
+ *
+ *  The average and maximum are computed over a fixed window of the latest values,
+ *  while the total covers all values ever added.
+ */
+class RollingSeries {
+public:
+  /*! \brief Creates an empty series.
+   *  \param window the number of recent values taken into account for average and maximum.
+   */
+  explicit RollingSeries(size_t window = 100);
+
+  /// Appends a value, dropping the oldest one if the window is full.
+  void add(double value);
+
+  /// the most recently added value, or zero if empty
+  double last() const;
+
+  /// the average of the values in the window, or zero if empty
+  double average() const;
+
+  /// the maximum of the values in the window, or zero if empty
+  double max() const;
+
+  /// the sum of all values ever added
+  double total() const;
+
+  /// the number of values ever added
+  size_t samples() const;
+
+private:
+  size_t m_window;
+  /// the values in the window, used as a ring buffer once full
+  std::vector<double> m_values;
+  /// the index the next value is written to
+  size_t m_next = 0;
+  /// the sum of the values currently in the window
+  double m_windowSum = 0;
+  double m_total = 0;
+  size_t m_samples = 0;
+};
+
+/*! \brief Collects per-step measurements of a World.
+ *
+ *  Timings are recorded once per system and step. Counters are accumulated during a step
+ *  by whichever system does the counted work, and moved to their series by \ref finishStep.
+ */
+class Statistics {
+public:
+  /// Quantities counted during a step.
+  enum class Counter {
+    /// pairs of colliders reported by the broadphase
+    CandidatePairs,
+    /// pixels examined by the narrowphase, skipped empty and accepted full blocks do not count
+    PixelsTested,
+    /// emitted events::EntityCollision events
+    CollisionEvents,
+    /// processed events::Explode events
+    Explosions,
+    /// live particles at the end of the step
+    Particles,
+  };
+
+  /// The number of distinct counters.
+  static constexpr size_t CounterCount = 5;
+
+  /// The time spent in a single system.
+  struct Timing {
+    /// the name of the system
+    std::string name;
+    /// the duration of the system's updates in seconds
+    RollingSeries seconds;
+  };
+
+  /*! \brief Creates empty statistics.
+   *  \param window the number of steps taken into account for averages and maxima.
+   */
+  explicit Statistics(size_t window = 100);
+
+  /// Copies the statistics, including the counts of the current step.
+  Statistics(const Statistics& other);
+
+  /// \copydoc Statistics(const Statistics&)
+  Statistics& operator=(const Statistics& other);
+
+  /*! \brief Registers a timed system.
+   *  \returns the index to be passed to \ref recordTiming.
+   */
+  size_t addTiming(std::string name);
+
+  /*! \brief Records the duration of one update of a system.
+   *
+   *  May be called concurrently for different systems.
+   */
+  void recordTiming(size_t index, double seconds);
+
+  /// the number of steps taken into account for averages and maxima
+  size_t window() const;
+
+  /*! \brief Increments a counter of the current step.
+   *
+   *  May be called concurrently by systems running in parallel.
+   */
+  void count(Counter counter, size_t amount = 1) {
+    m_currentCounts[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  /// Completes the current step, moving the counted values into their series.
+  void finishStep();
+
+  /// the timings of all systems, in the order they were registered
+  const std::vector<Timing>& timings() const;
+
+  /// the per-step series of a counter
+  const RollingSeries& counter(Counter counter) const;
+
+  /// a human readable name of a counter
+  static const char* counterName(Counter counter);
+
+private:
+  size_t m_window;
+  std::vector<Timing> m_timings;
+  std::array<std::atomic<size_t>, CounterCount> m_currentCounts{};
+  std::vector<RollingSeries> m_counters;
+};
+
+}
+}
@@ -2,10 +2,13 @@
 
 #include "systems/attractionsystem.hpp"
 #include "systems/boundaryenforcer.hpp"
+#include "systems/boundingvolumes.hpp"
 #include "systems/bounce.hpp"
 #include "systems/collision.hpp"
 #include "systems/debug.hpp"
 #include "systems/explosions.hpp"
+#include "systems/fragmentation.hpp"
 #include "systems/healthsystem.hpp"
+#include "systems/particles.hpp"
 #include "systems/physics.hpp"
 #include "systems/projectiles.hpp"
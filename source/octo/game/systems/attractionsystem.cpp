@@ -3,49 +3,311 @@
 #include "../components/attraction.hpp"
 #include "../components/dynamicbody.hpp"
 #include "../components/spatial.hpp"
-#include <octo/math/vector.hpp>
+#include "../gravity/force.hpp"
 
-#include <cmath>
-#include <iostream>
+#include <algorithm>
 
 using namespace octo::game::systems;
 using namespace entityx;
 
+namespace {
+/*! \brief Looks up the entry for an attraction mask in a list of (mask, value) pairs.
+ *
+ *  A default constructed value is appended if there is no entry for \p mask yet.
+ */
+template <typename Groups>
+auto& groupFor(Groups& groups, sf::Uint64 mask) {
+  auto group = std::find_if(
+      begin(groups), end(groups), [mask](const auto& g) { return g.first == mask; });
+  if (group == end(groups)) {
+    groups.emplace_back();
+    group = end(groups) - 1;
+    group->first = mask;
+  }
+  return group->second;
+}
+}
+
+void Attraction::configure(EventManager& events) {
+  events.subscribe<ComponentAddedEvent<components::Attractor>>(*this);
+  events.subscribe<ComponentRemovedEvent<components::Attractor>>(*this);
+}
+
+octo::game::SystemAccess Attraction::access() {
+  using namespace components;
+  return SystemAccess()
+      .reads<Spatial, Attractor, Attractable>()
+      .writes<DynamicBody>()
+      .receives<entityx::ComponentAddedEvent<Attractor>,
+                entityx::ComponentRemovedEvent<Attractor>>();
+}
+
 void Attraction::update(EntityManager& es, EventManager&, TimeDelta dt) {
+  if (m_staticFieldEnabled && (m_staticFieldDirty || staticAttractorsChanged(es))) {
+    rebuildStaticField(es);
+  }
+  gatherAttractors(es);
+  gatherAttractables(es);
+  switch (m_mode) {
+  case Mode::Pairwise:
+    break;
+  case Mode::Vectorized:
+    buildBatches();
+    break;
+  case Mode::BarnesHut:
+    buildTrees();
+    break;
+  }
+
+  auto applyForces = [this](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      m_attractables[i].body->force += force(m_attractables[i]);
+    }
+  };
+  if (m_threadPool) {
+    m_threadPool->parallelFor(m_attractables.size(), m_chunkSize, applyForces);
+  } else {
+    applyForces(0, m_attractables.size());
+  }
+}
+
+void Attraction::receive(const ComponentAddedEvent<components::Attractor>&) {
+  m_staticFieldDirty = true;
+}
+
+void Attraction::receive(const ComponentRemovedEvent<components::Attractor>&) {
+  m_staticFieldDirty = true;
+}
+
+Attraction::Mode Attraction::mode() const {
+  return m_mode;
+}
+
+void Attraction::setMode(Mode mode) {
+  m_mode = mode;
+}
+
+float Attraction::openingAngle() const {
+  return m_openingAngle;
+}
+
+void Attraction::setOpeningAngle(float openingAngle) {
+  m_openingAngle = openingAngle;
+}
+
+bool Attraction::staticFieldEnabled() const {
+  return m_staticFieldEnabled;
+}
+
+void Attraction::setStaticFieldEnabled(bool enabled) {
+  m_staticFieldEnabled = enabled;
+  m_staticFieldDirty = true;
+}
+
+void Attraction::setFieldRadius(float radius) {
+  m_fieldRadius = radius;
+  m_staticFieldDirty = true;
+}
+
+size_t Attraction::threadCount() const {
+  return m_threadPool ? m_threadPool->size() : 0;
+}
+
+void Attraction::setThreadCount(size_t threads) {
+  if (threads != threadCount()) {
+    m_threadPool.reset(threads > 0 ? new util::ThreadPool(threads) : nullptr);
+  }
+}
+
+void Attraction::gatherAttractors(EntityManager& es) {
+  using namespace octo::game::components;
+  m_attractors.clear();
+  es.each<Spatial, Attractor>([this](Entity entity, Spatial& spatial, Attractor& attractor) {
+    // static attractors are handled by the precomputed field
+    if (!m_staticFieldEnabled || entity.has_component<DynamicBody>()) {
+      m_attractors.push_back({spatial.current().position,
+                              attractor.intensity,
+                              attractor.radius,
+                              attractor.attractionMask});
+    }
+  });
+}
+
+void Attraction::gatherAttractables(EntityManager& es) {
+  using namespace octo::game::components;
+  m_attractables.clear();
+  es.each<Spatial, Attractable, DynamicBody>(
+      [this](Entity, Spatial& spatial, Attractable& attractable, DynamicBody& body) {
+        m_attractables.push_back({spatial.current().position,
+                                  attractable.intensity,
+                                  attractable.attractionMask,
+                                  &body});
+      });
+}
+
+void Attraction::buildBatches() {
+  for (auto& batch : m_batches) {
+    batch.second.clear();
+  }
+  for (auto& attractor : m_attractors) {
+    groupFor(m_batches, attractor.attractionMask)
+        .add(attractor.position, attractor.intensity, attractor.radius);
+  }
+  m_batches.erase(std::remove_if(begin(m_batches),
+                                 end(m_batches),
+                                 [](const auto& b) { return b.second.empty(); }),
+                  end(m_batches));
+}
+
+void Attraction::buildTrees() {
+  // rebuild the trees, keeping their storage around between updates
+  for (auto& tree : m_trees) {
+    tree.second.clear();
+  }
+  for (auto& attractor : m_attractors) {
+    groupFor(m_trees, attractor.attractionMask)
+        .insert({attractor.position, attractor.intensity, attractor.radius});
+  }
+  m_trees.erase(std::remove_if(begin(m_trees),
+                               end(m_trees),
+                               [](const auto& t) { return t.second.empty(); }),
+                end(m_trees));
+  for (auto& tree : m_trees) {
+    tree.second.build();
+  }
+}
+
+void Attraction::rebuildStaticField(EntityManager& es) {
   using namespace octo::game::components;
-  // component iterators
-  ComponentHandle<Spatial> attractedPos, attractorPos;
-  ComponentHandle<Attractor> attractor;
-  ComponentHandle<Attractable> attractable;
-  ComponentHandle<DynamicBody> attractedBody;
-  // traverse entities that can be attracted
-  for(Entity e1 : es.entities_with_components(attractedPos, attractable, attractedBody)) {
-    (void)e1;
-    // traverse attracting entities
-    for(Entity e2 : es.entities_with_components(attractorPos, attractor)) {
-      (void)e2;
-      if((attractable->attractionMask & attractor->attractionMask) != 0) {
-        // compute attraction force towards attractor with quadratic falloff
-        sf::Vector2f forceDir = attractorPos->current().position - attractedPos->current().position;
-        float distanceSq = math::vector::lengthSquared(forceDir);
-        float distance = static_cast<float>(sqrt(distanceSq));
-        float radius = attractor->radius;
-        float radiusSq = radius * radius;
-
-        forceDir /= distance;
-        sf::Vector2f force = forceDir * attractable->intensity * attractor->intensity;
-        if(__builtin_expect(distanceSq < radiusSq, 0)) {
-          // when inside the attractor, reduce force towards center based on an approximation
-          // computed from the ratio of the two parts pulling the object further inwards,
-          // and pulling it outwards.
-          float alpha = distance * (3 * radiusSq -  distanceSq) / (2 * radiusSq * radius);
-          force *= alpha / radiusSq;
-          //std::cout << "force: " << math::vector::length(force) << "\n";
-        } else {
-          force /= distanceSq;
+  m_staticAttractors.clear();
+  es.each<Spatial, Attractor>([this](Entity entity, Spatial& spatial, Attractor& attractor) {
+    if (!entity.has_component<DynamicBody>()) {
+      m_staticAttractors.push_back({spatial.current().position,
+                                    attractor.intensity,
+                                    attractor.radius,
+                                    attractor.attractionMask});
+    }
+  });
+
+  m_fields.clear();
+  for (auto& attractor : m_staticAttractors) {
+    auto& field = groupFor(m_fields, attractor.attractionMask);
+    if (field.empty()) {
+      field.reset(m_fieldRadius, m_fieldCellSize);
+    }
+    field.add(attractor.position, attractor.intensity, attractor.radius);
+  }
+  m_staticFieldDirty = false;
+}
+
+bool Attraction::staticAttractorsChanged(EntityManager& es) const {
+  using namespace octo::game::components;
+  // static attractors are visited in the same order as by rebuildStaticField
+  size_t index = 0;
+  bool changed = false;
+  es.each<Spatial, Attractor>([&](Entity entity, Spatial& spatial, Attractor& attractor) {
+    if (changed || entity.has_component<DynamicBody>()) {
+      return;
+    }
+    if (index == m_staticAttractors.size()) {
+      changed = true;
+      return;
+    }
+    const AttractorData& cached = m_staticAttractors[index++];
+    changed = cached.position != spatial.current().position ||
+              cached.intensity != attractor.intensity || cached.radius != attractor.radius ||
+              cached.attractionMask != attractor.attractionMask;
+  });
+  return changed || index != m_staticAttractors.size();
+}
+
+void Attraction::accelerations(const float* x, const float* y, size_t count,
+                               sf::Uint64 attractionMask, float* ax, float* ay) const {
+  auto compute = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      sf::Vector2f a = force({{x[i], y[i]}, 1, attractionMask, nullptr});
+      ax[i] = a.x;
+      ay[i] = a.y;
+    }
+  };
+  if (m_threadPool) {
+    m_threadPool->parallelFor(count, m_chunkSize, compute);
+  } else {
+    compute(0, count);
+  }
+}
+
+sf::Vector2f Attraction::force(const AttractableData& attractable) const {
+  sf::Vector2f total;
+  switch (m_mode) {
+  case Mode::Pairwise:
+    total = pairwiseForce(attractable);
+    break;
+  case Mode::Vectorized:
+    total = vectorizedForce(attractable);
+    break;
+  case Mode::BarnesHut:
+    total = barnesHutForce(attractable);
+    break;
+  }
+  if (m_staticFieldEnabled) {
+    total += staticFieldForce(attractable);
+  }
+  return total;
+}
+
+sf::Vector2f Attraction::pairwiseForce(const AttractableData& attractable) const {
+  sf::Vector2f total;
+  // traverse attracting entities
+  for (auto& attractor : m_attractors) {
+    if ((attractable.attractionMask & attractor.attractionMask) != 0) {
+      // compute attraction force towards attractor with quadratic falloff
+      total += gravity::attractionForce(attractor.position - attractable.position,
+                                        attractable.intensity * attractor.intensity,
+                                        attractor.radius);
+    }
+  }
+  return total;
+}
+
+sf::Vector2f Attraction::vectorizedForce(const AttractableData& attractable) const {
+  sf::Vector2f total;
+  for (auto& batch : m_batches) {
+    if ((attractable.attractionMask & batch.first) != 0) {
+      total += batch.second.force(attractable.position, attractable.intensity);
+    }
+  }
+  return total;
+}
+
+sf::Vector2f Attraction::barnesHutForce(const AttractableData& attractable) const {
+  sf::Vector2f total;
+  for (auto& tree : m_trees) {
+    if ((attractable.attractionMask & tree.first) != 0) {
+      total += tree.second.force(attractable.position, attractable.intensity, m_openingAngle);
+    }
+  }
+  return total;
+}
+
+sf::Vector2f Attraction::staticFieldForce(const AttractableData& attractable) const {
+  sf::Vector2f total;
+  for (auto& field : m_fields) {
+    if ((attractable.attractionMask & field.first) == 0) {
+      continue;
+    }
+    if (field.second.contains(attractable.position)) {
+      total += field.second.sample(attractable.position) * attractable.intensity;
+    } else {
+      // outside of the grid, fall back to the exact computation
+      for (auto& attractor : m_staticAttractors) {
+        if (attractor.attractionMask == field.first) {
+          total += gravity::attractionForce(attractor.position - attractable.position,
+                                            attractable.intensity * attractor.intensity,
+                                            attractor.radius);
         }
-        attractedBody->force += force;
       }
     }
   }
+  return total;
 }
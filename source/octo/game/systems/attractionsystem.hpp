@@ -1,6 +1,20 @@
 #pragma once
 
+#include "../components/attraction.hpp"
+#include "../components/dynamicbody.hpp"
+#include "../gravity/attractorbatch.hpp"
+#include "../gravity/barneshut.hpp"
+#include "../gravity/fieldgrid.hpp"
+#include "../scheduler.hpp"
+#include <octo/util/threadpool.hpp>
+
 #include <entityx/entityx.h>
+#include <SFML/Config.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace octo {
 namespace game {
@@ -37,8 +51,33 @@ namespace systems {
  *  Hence, there is no sudden change in force at the boundary. However, this approximation does not
  *  preserve the derivative of the force (somehow related to the physical measure of "jerk") at the boundary.
  *
+ *  In \ref Mode::BarnesHut mode, the attractors are organized in a gravity::BarnesHutTree that is
+ *  rebuilt once per update. Distant groups of attractors are then approximated by a single one,
+ *  controlled by the \ref openingAngle.
+ *
+ *  Attractors without a \ref components::DynamicBody never move. When the static field is
+ *  enabled, their forces are precomputed once on a gravity::FieldGrid covering the world and
+ *  only sampled afterwards. The grid is rebuilt when an \ref components::Attractor is added or
+ *  removed, or when the position or parameters of a static attractor differ from the ones the
+ *  grid was computed from.
+ *
+ *  Since the force acting on an attractable does not depend on other attractables, they can be
+ *  processed in parallel on a pool of worker threads, see \ref setThreadCount.
  */
-struct Attraction : public entityx::System<Attraction> {
+struct Attraction : public entityx::System<Attraction>, public entityx::Receiver<Attraction> {
+  /// Available strategies for computing the attractive forces.
+  enum class Mode {
+    /// Every attractable is checked against every attractor.
+    Pairwise,
+    /// Every attractable is checked against all attractors at once using SIMD instructions.
+    Vectorized,
+    /// Attractors are approximated using a Barnes-Hut quadtree.
+    BarnesHut,
+  };
+
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
   /*! \brief Calculates and adds the attractive forces.
    *
    *  Only entities having a \ref components::Spatial component are considered.
@@ -52,6 +91,155 @@ struct Attraction : public entityx::System<Attraction> {
    *  \idea provide different kinds of falloffs
    */
   void update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) override;
+
+  /*! \brief Subscribes to changes of \ref components::Attractor components.
+   */
+  void configure(entityx::EventManager& events) override;
+
+  void receive(const entityx::ComponentAddedEvent<components::Attractor>& event);
+
+  void receive(const entityx::ComponentRemovedEvent<components::Attractor>& event);
+
+  /*! \brief Computes the accelerations of points of unit intensity, e.g. of particles.
+   *
+   *  The attractors gathered by the last \ref update are used, hence it must only be called
+   *  by systems running after this one. The points are distributed among the worker threads.
+   *  \param x the x coordinates of the points.
+   *  \param y the y coordinates of the points.
+   *  \param count the number of points.
+   *  \param attractionMask the attractors the points are affected by.
+   *  \param ax receives the x components of the accelerations.
+   *  \param ay receives the y components of the accelerations.
+   */
+  void accelerations(const float* x, const float* y, size_t count, sf::Uint64 attractionMask,
+                     float* ax, float* ay) const;
+
+  /// the strategy used for computing forces
+  Mode mode() const;
+
+  /// sets the strategy used for computing forces
+  void setMode(Mode mode);
+
+  /*! \brief The opening angle used in \ref Mode::BarnesHut mode.
+   *
+   *  A node of the quadtree is approximated as a whole when the ratio of its size and its distance
+   *  to the attractable is below this value. Smaller values are more accurate, but slower.
+   */
+  float openingAngle() const;
+
+  /// sets the opening angle used in \ref Mode::BarnesHut mode
+  void setOpeningAngle(float openingAngle);
+
+  /// whether the forces of static attractors are precomputed
+  bool staticFieldEnabled() const;
+
+  /// enables or disables precomputing the forces of static attractors
+  void setStaticFieldEnabled(bool enabled);
+
+  /*! \brief Sets the region covered by the static field.
+   *
+   *  Attractables outside of this radius around the origin use the exact computation.
+   *  \param radius the new radius, usually the clip radius of the world.
+   */
+  void setFieldRadius(float radius);
+
+  /*! \brief The number of worker threads used for computing forces.
+   *
+   *  The forces acting on different attractables are computed independently on the workers.
+   *  The result does not depend on the number of threads.
+   */
+  size_t threadCount() const;
+
+  /*! \brief Sets the number of worker threads used for computing forces.
+   *  \param threads the number of worker threads, zero computes all forces on the calling thread.
+   */
+  void setThreadCount(size_t threads);
+
+private:
+  /// An attractor gathered from the entity system for the current update.
+  struct AttractorData {
+    sf::Vector2f position;
+    float intensity;
+    float radius;
+    sf::Uint64 attractionMask;
+  };
+
+  /// An attractable gathered from the entity system for the current update.
+  struct AttractableData {
+    sf::Vector2f position;
+    float intensity;
+    sf::Uint64 attractionMask;
+    /// the body receiving the force, only written by the thread processing this attractable
+    components::DynamicBody* body;
+  };
+
+  /// Collects all attractors not covered by the static field into \ref m_attractors.
+  void gatherAttractors(entityx::EntityManager& es);
+
+  /// Collects all attractables into \ref m_attractables.
+  void gatherAttractables(entityx::EntityManager& es);
+
+  /// Packs the attractors into one gravity::AttractorBatch per attraction mask.
+  void buildBatches();
+
+  /// Organizes the attractors in one gravity::BarnesHutTree per attraction mask.
+  void buildTrees();
+
+  /// Recomputes the static field grids from all static attractors.
+  void rebuildStaticField(entityx::EntityManager& es);
+
+  /*! \brief Checks whether the static attractors differ from \ref m_staticAttractors.
+   *
+   *  Attractors are modified in place, so their cached positions and parameters are compared
+   *  on every update. There are only a few static attractors, e.g. the planets.
+   */
+  bool staticAttractorsChanged(entityx::EntityManager& es) const;
+
+  /*! \brief Computes the total force acting on an attractable.
+   *
+   *  This function only reads the data prepared for the current update,
+   *  hence it can be called concurrently for different attractables.
+   */
+  sf::Vector2f force(const AttractableData& attractable) const;
+
+  /// Checks the attractable against every attractor.
+  sf::Vector2f pairwiseForce(const AttractableData& attractable) const;
+
+  /// Checks the attractable against all attractors using the packed batches.
+  sf::Vector2f vectorizedForce(const AttractableData& attractable) const;
+
+  /// Approximates the force using the quadtrees.
+  sf::Vector2f barnesHutForce(const AttractableData& attractable) const;
+
+  /// Computes the force of static attractors, sampled from the static field.
+  sf::Vector2f staticFieldForce(const AttractableData& attractable) const;
+
+private:
+  Mode m_mode = Mode::Pairwise;
+  float m_openingAngle = 0.5f;
+  /// The attractors considered by the current update.
+  std::vector<AttractorData> m_attractors;
+  /// The attractables considered by the current update.
+  std::vector<AttractableData> m_attractables;
+
+  /// Computes forces in parallel, null when running on the calling thread.
+  std::unique_ptr<util::ThreadPool> m_threadPool;
+  /// the number of attractables processed by one task
+  size_t m_chunkSize = 256;
+
+  bool m_staticFieldEnabled = false;
+  /// Set whenever the static attractors have changed.
+  bool m_staticFieldDirty = true;
+  float m_fieldRadius = 1000;
+  float m_fieldCellSize = 4;
+  /// Static attractors, used for attractables outside of the field.
+  std::vector<AttractorData> m_staticAttractors;
+  /// One field per distinct attraction mask of the static attractors.
+  std::vector<std::pair<sf::Uint64, gravity::FieldGrid>> m_fields;
+  /// One tree per distinct attraction mask of the attractors, reused between updates.
+  std::vector<std::pair<sf::Uint64, gravity::BarnesHutTree>> m_trees;
+  /// One batch per distinct attraction mask of the attractors, reused between updates.
+  std::vector<std::pair<sf::Uint64, gravity::AttractorBatch>> m_batches;
 };
 
 }
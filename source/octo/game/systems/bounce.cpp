@@ -12,6 +12,14 @@ using namespace octo::game::systems;
 
 Bounce::Bounce() {}
 
+octo::game::SystemAccess Bounce::access() {
+  using namespace components;
+  return SystemAccess()
+      .receives<events::EntityCollision>()
+      .reads<Spatial, Material>()
+      .writes<DynamicBody>();
+}
+
 void Bounce::update(entityx::EntityManager& es, entityx::EventManager&, entityx::TimeDelta dt) {
   std::for_each(begin(m_collisions), end(m_collisions), Bounce::bounce);
   m_collisions.clear();
@@ -41,7 +49,10 @@ void Bounce::bounce(events::EntityCollision& colData) {
       // entities without material do not bounce
       return;
     }
-    lcont[i] = spatials[i]->current().globalToLocal(false).transformPoint(colData.contactPoint);
+    // the contact refers to the positions at the time of impact
+    const components::SpatialSnapshot impact =
+        components::lerp(spatials[i]->previous(), spatials[i]->current(), colData.timeOfImpact);
+    lcont[i] = impact.globalToLocal(false).transformPoint(colData.contactPoint);
     if (bodies[i].valid()) {
       contactMomenta[i] = bodies[i]->momentumAt(lcont[i]);
       contactMomentum += contactMomenta[i];
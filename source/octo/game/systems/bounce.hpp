@@ -4,6 +4,7 @@
 #include "../components/dynamicbody.hpp"
 #include "../events/entitycollision.hpp"
 #include "../world.hpp"
+#include "../scheduler.hpp"
 #include <fmtlog/fmtlog.hpp>
 
 #include <entityx/entityx.h>
@@ -19,6 +20,9 @@ namespace systems {
 struct Bounce : public entityx::System<Bounce>, public entityx::Receiver<Bounce> {
   Bounce();
 
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
   /*! \brief Performs collision response calculations for all collisions that happened in the current frame.
    *  \param es The entity system involved.
    *  \param events (unused)
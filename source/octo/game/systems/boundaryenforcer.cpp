@@ -14,6 +14,10 @@ float BoundaryEnforcer::boundaryRadius() const {
   return m_boundary;
 }
 
+octo::game::SystemAccess BoundaryEnforcer::access() {
+  return SystemAccess().reads<components::Spatial>().changesEntities();
+}
+
 void BoundaryEnforcer::update(entityx::EntityManager& es, entityx::EventManager&,
                               entityx::TimeDelta) {
   es.each<components::Spatial>([&](entityx::Entity entity, components::Spatial& spatial) {
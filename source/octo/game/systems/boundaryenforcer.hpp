@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../components/spatial.hpp"
+#include "../scheduler.hpp"
 
 #include <fmtlog/fmtlog.hpp>
 
@@ -25,6 +26,9 @@ struct BoundaryEnforcer : public entityx::System<BoundaryEnforcer> {
   /// returns the current boundary radius
   float boundaryRadius() const;
 
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
   /*! \brief Destroys all entities outside of the boundary.
    *
    *  This affects all entities with a \ref components::Spatial component.
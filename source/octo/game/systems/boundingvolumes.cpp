@@ -0,0 +1,95 @@
+#include "boundingvolumes.hpp"
+
+#include "../collision/util.hpp"
+#include "../components.hpp"
+
+#include <cmath>
+
+namespace octo {
+namespace game {
+namespace systems {
+
+BoundingVolumes::BoundingVolumes(World& world) : m_world(world) {}
+
+SystemAccess BoundingVolumes::access() {
+  using namespace components;
+  return SystemAccess()
+      .reads<Spatial, CollisionMask, DynamicBody>()
+      .writes<collision::AabbTree>()
+      .receives<entityx::ComponentAddedEvent<CollisionMask>,
+                entityx::ComponentRemovedEvent<CollisionMask>,
+                events::ComponentModified<CollisionMask>,
+                entityx::EntityDestroyedEvent>();
+}
+
+void BoundingVolumes::configure(entityx::EventManager& events) {
+  events.subscribe<entityx::ComponentAddedEvent<components::CollisionMask>>(*this);
+  events.subscribe<entityx::ComponentRemovedEvent<components::CollisionMask>>(*this);
+  events.subscribe<events::ComponentModified<components::CollisionMask>>(*this);
+  events.subscribe<entityx::EntityDestroyedEvent>(*this);
+}
+
+void BoundingVolumes::receive(const entityx::ComponentAddedEvent<components::CollisionMask>& event) {
+  m_pending.push_back(event.entity);
+}
+
+void BoundingVolumes::receive(const entityx::ComponentRemovedEvent<components::CollisionMask>& event) {
+  removeProxy(event.entity.id());
+}
+
+void BoundingVolumes::receive(const events::ComponentModified<components::CollisionMask>& event) {
+  m_pending.push_back(event.entity);
+}
+
+void BoundingVolumes::receive(const entityx::EntityDestroyedEvent& event) {
+  removeProxy(event.entity.id());
+}
+
+void BoundingVolumes::update(entityx::EntityManager& es, entityx::EventManager& events,
+                             entityx::TimeDelta dt) {
+  using namespace components;
+  for (entityx::Entity entity : m_pending) {
+    if (entity.valid()) {
+      auto spatial = entity.component<Spatial>();
+      auto mask = entity.component<CollisionMask>();
+      if (spatial && mask) {
+        updateProxy(entity, *spatial, *mask);
+      }
+    }
+  }
+  m_pending.clear();
+  es.each<Spatial, CollisionMask, DynamicBody>(
+      [this](entityx::Entity entity, Spatial& spatial, CollisionMask& mask, DynamicBody&) {
+        updateProxy(entity, spatial, mask);
+      });
+}
+
+void BoundingVolumes::updateProxy(entityx::Entity entity, const components::Spatial& spatial,
+                                  const components::CollisionMask& mask) {
+  sf::FloatRect aabb =
+      collision::maskToGlobal(spatial.current(), mask).transformRect({{0.f, 0.f}, mask.size()});
+  auto proxy = m_proxies.find(entity.id().id());
+  // entities with invalid coordinates cannot be found (they are reported by the BoundaryEnforcer)
+  if (!std::isfinite(aabb.left) || !std::isfinite(aabb.top)) {
+    if (proxy != m_proxies.end()) {
+      m_world.aabbTree().remove(proxy->second);
+      m_proxies.erase(proxy);
+    }
+  } else if (proxy == m_proxies.end()) {
+    m_proxies.emplace(entity.id().id(), m_world.aabbTree().insert(aabb, entity.id().id()));
+  } else {
+    m_world.aabbTree().move(proxy->second, aabb);
+  }
+}
+
+void BoundingVolumes::removeProxy(entityx::Entity::Id id) {
+  auto proxy = m_proxies.find(id.id());
+  if (proxy != m_proxies.end()) {
+    m_world.aabbTree().remove(proxy->second);
+    m_proxies.erase(proxy);
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../collision/aabbtree.hpp"
+#include "../components/collisionmask.hpp"
+#include "../components/spatial.hpp"
+#include "../events/componentmodified.hpp"
+#include "../world.hpp"
+#include "../scheduler.hpp"
+
+#include <entityx/entityx.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace systems {
+
+/*! \brief This system keeps the World's collision::AabbTree in sync with the entities.
+ *
+ *  Only entities with a \ref components::DynamicBody are updated every step. All other
+ *  entities, e.g. planets, are considered static: they are inserted when their
+ *  \ref components::CollisionMask is added and only updated when a events::ComponentModified
+ *  event is raised for it.
+ */
+struct BoundingVolumes : public entityx::System<BoundingVolumes>,
+                         public entityx::Receiver<BoundingVolumes> {
+  BoundingVolumes(World& world);
+
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
+  /*! \brief Subscribes to changes of \ref components::CollisionMask components and entities.
+   */
+  void configure(entityx::EventManager& events) override;
+
+  void receive(const entityx::ComponentAddedEvent<components::CollisionMask>& event);
+
+  void receive(const entityx::ComponentRemovedEvent<components::CollisionMask>& event);
+
+  void receive(const events::ComponentModified<components::CollisionMask>& event);
+
+  void receive(const entityx::EntityDestroyedEvent& event);
+
+  /*! \brief Updates the bounding boxes of moving entities and of changed static ones.
+   */
+  void update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) override;
+
+private:
+  /// Inserts or moves the bounding box of an entity in the tree.
+  void updateProxy(entityx::Entity entity, const components::Spatial& spatial,
+                   const components::CollisionMask& mask);
+
+  /// Removes an entity from the tree, if it is stored.
+  void removeProxy(entityx::Entity::Id id);
+
+  World& m_world;
+  /// the proxies of the entities stored in the tree, by entity id
+  std::unordered_map<std::uint64_t, collision::AabbTree::Proxy> m_proxies;
+  /// entities whose bounding boxes must be updated even if they are static
+  std::vector<entityx::Entity> m_pending;
+};
+
+}
+}
+}
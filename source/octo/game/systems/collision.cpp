@@ -1,89 +1,381 @@
 #include "collision.hpp"
 
+#include "../collision/affineoverlap.hpp"
 #include "../collision/util.hpp"
 #include "../components.hpp"
 #include "../events/entitycollision.hpp"
 #include <octo/math/rect.hpp>
 #include <octo/math/vector.hpp>
-#include <octo/util/rectiterator.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 using namespace octo::game::systems;
 
+namespace {
+/// marks proxies without a collider in the current update
+const size_t NoCollider = std::numeric_limits<size_t>::max();
+
+/// the maximum number of positions checked along the path of a fast collider
+const size_t MaxSweepSteps = 64;
+}
+
 Collision::Collision(World& world) : m_world(world) {}
 
+void Collision::configure(entityx::EventManager& events) {
+  events.subscribe<entityx::ComponentRemovedEvent<components::CollisionMask>>(*this);
+  events.subscribe<entityx::EntityDestroyedEvent>(*this);
+}
+
+void Collision::receive(const entityx::ComponentRemovedEvent<components::CollisionMask>& event) {
+  removeProxy(event.entity.id());
+}
+
+void Collision::receive(const entityx::EntityDestroyedEvent& event) {
+  removeProxy(event.entity.id());
+}
+
+octo::game::SystemAccess Collision::access() {
+  using namespace components;
+  return SystemAccess()
+      .reads<Spatial, CollisionMask, Projectile>()
+      .receives<entityx::ComponentRemovedEvent<CollisionMask>, entityx::EntityDestroyedEvent>()
+      .emits<events::EntityCollision>();
+}
+
 void Collision::update(entityx::EntityManager& es, entityx::EventManager& events,
                        entityx::TimeDelta dt) {
+  gatherColliders(es);
+  switch (m_broadphase) {
+  case Broadphase::BruteForce:
+    findPairsBruteForce();
+    break;
+  case Broadphase::SpatialHash:
+    findPairsSpatialHash();
+    break;
+  case Broadphase::SweepAndPrune:
+    findPairsSweepAndPrune();
+    break;
+  }
+  m_world.statistics().count(Statistics::Counter::CandidatePairs, m_pairs.size());
+  for (auto& pair : m_pairs) {
+    const Collider& first = m_colliders[pair.first];
+    const Collider& second = m_colliders[pair.second];
+    if ((first.mask->selector & second.mask->selector) == 0) {
+      continue;
+    }
+    bool traceFirst = first.hitbox != components::Projectile::Hitbox::Mask;
+    bool traceSecond = second.hitbox != components::Projectile::Hitbox::Mask;
+    if (traceFirst != traceSecond) {
+      // projectiles are traced through the other entity's mask, unless both of them are projectiles
+      traceNarrowphase(traceFirst ? first : second, traceFirst ? second : first, events);
+    } else if (first.entity < second.entity) {
+      // use artificial order to report every pair the same way
+      narrowphase(first, second, events);
+    } else {
+      narrowphase(second, first, events);
+    }
+  }
+}
+
+Collision::Broadphase Collision::broadphase() const {
+  return m_broadphase;
+}
+
+void Collision::setBroadphase(Broadphase broadphase) {
+  m_broadphase = broadphase;
+  // the persistent state would miss all changes made while another broadphase is in use
+  m_sweepAndPrune.clear();
+  m_proxies.clear();
+}
+
+void Collision::gatherColliders(entityx::EntityManager& es) {
   using namespace components;
-  es.each<Spatial, CollisionMask>([&](
-      entityx::Entity entityA, Spatial& spatialA, CollisionMask& maskA) {
-    es.each<Spatial, CollisionMask>([&](
-        entityx::Entity entityB, Spatial& spatialB, CollisionMask& maskB) {
-      // use artificial order to only process every pair once
-      if (entityA < entityB && (maskA.selector & maskB.selector) != 0) {
-        // setup transformation from A's pixels to B's pixels
-        sf::Transform localToWorldB = collision::maskToGlobal(spatialB.current(), maskB);
-
-        sf::Transform atob = collision::globalToMask(spatialB.current(), maskB) *
-                             collision::maskToGlobal(spatialA.current(), maskA);
-
-        sf::Transform btoa{atob.getInverse()};
-
-        // first check AABB
-        sf::Rect<size_t> pixRectA{{0, 0}, maskA.mask.size()};
-        sf::Rect<size_t> pixRectB{{0, 0}, maskB.mask.size()};
-        sf::FloatRect pixRectAtoB = atob.transformRect(math::rect::rect_cast<float>(pixRectA));
-        sf::FloatRect intersection;
-        if (pixRectAtoB.intersects(math::rect::rect_cast<float>(pixRectB), intersection)) {
-          // if AABBs intersect, check pixels
-          sf::Rect<size_t> area = math::rect::integralOutwards<size_t>(intersection);
-          // compute average of colliding pixels
-          sf::Vector2f contactPoint{0, 0};
-          size_t numContacts = 0;
-          for (auto& bpos : util::rectRange(area)) {
-            if (maskB.mask.at(bpos.x, bpos.y) != collision::Pixel::NoCollision) {
-              auto apos = math::vector::map(btoa.transformPoint(bpos.x, bpos.y), [](float x) {
-                return static_cast<size_t>(std::round(x));
-              });
-              if (pixRectA.contains(apos) &&
-                  maskA.mask.at(apos.x, apos.y) != collision::Pixel::NoCollision) {
-                contactPoint += localToWorldB.transformPoint(bpos.x, bpos.y);
-                numContacts += 1;
-              }
-            }
-          }
-          // if there was a collision, compute contact
-          if (numContacts > 0) {
-            // average of overlapping pixels
-            contactPoint /= static_cast<float>(numContacts);
-            sf::Vector2f contactA =
-                collision::globalToMask(spatialA.current(), maskA).transformPoint(contactPoint);
-            sf::Vector2f contactB =
-                collision::globalToMask(spatialB.current(), maskB).transformPoint(contactPoint);
-            sf::Vector2f normalA = math::vector::rotate(
-                spatialA.current().rotationRadians(),
-                collision::computeNormal(maskA.mask, m_normalAccuracy, contactA.x, contactA.y));
-            sf::Vector2f normalB = math::vector::rotate(
-                spatialB.current().rotationRadians(),
-                collision::computeNormal(maskB.mask, m_normalAccuracy, contactB.x, contactB.y));
-            log.debug(
-                "collision [%s] and [%s] at (%.1f, %.1f); normals (%.2f, %.2f) and (%.2f, %.2f)",
-                entityA.id(),
-                entityB.id(),
-                contactPoint.x,
-                contactPoint.y,
-                normalA.x,
-                normalA.y,
-                normalB.x,
-                normalB.y);
-            events::EntityCollision collisionData(
-                {entityA, entityB}, {normalA, normalB}, contactPoint);
-            events.emit(collisionData);
-          }
+  m_colliders.clear();
+  es.each<Spatial, CollisionMask>(
+      [this](entityx::Entity entity, Spatial& spatial, CollisionMask& mask) {
+        Collider collider{entity, &spatial, &mask};
+        collider.maskToGlobal = collision::maskToGlobal(spatial.current(), mask);
+        collider.aabb = collider.maskToGlobal.transformRect({{0.f, 0.f}, mask.size()});
+        auto projectile = entity.component<Projectile>();
+        if (projectile) {
+          collider.hitbox = projectile->hitbox;
+        }
+        collider.displacement = spatial.current().position - spatial.previous().position;
+        collider.extent = std::min(mask.size().x, mask.size().y);
+        collider.fast = collider.hitbox == Projectile::Hitbox::Mask &&
+                        math::vector::lengthSquared(collider.displacement) >
+                            collider.extent * collider.extent;
+        if (collider.fast || collider.hitbox == Projectile::Hitbox::Segment) {
+          // the broadphase must find everything along the path
+          sf::Transform previous = collision::maskToGlobal(spatial.previous(), mask);
+          collider.aabb =
+              math::rect::merge(collider.aabb, previous.transformRect({{0.f, 0.f}, mask.size()}));
         }
+        // entities with invalid coordinates cannot collide (they are reported by the BoundaryEnforcer)
+        if (std::isfinite(collider.aabb.left) && std::isfinite(collider.aabb.top)) {
+          m_colliders.push_back(collider);
+        }
+      });
+}
+
+void Collision::findPairsBruteForce() {
+  m_pairs.clear();
+  for (size_t a = 0; a < m_colliders.size(); ++a) {
+    for (size_t b = a + 1; b < m_colliders.size(); ++b) {
+      m_pairs.emplace_back(a, b);
+    }
+  }
+}
+
+void Collision::findPairsSpatialHash() {
+  m_spatialHash.clear();
+  for (auto& collider : m_colliders) {
+    m_spatialHash.insert(collider.aabb);
+  }
+  m_spatialHash.findPairs(m_pairs);
+}
+
+void Collision::findPairsSweepAndPrune() {
+  m_proxyColliders.assign(m_sweepAndPrune.capacity(), NoCollider);
+  for (size_t i = 0; i < m_colliders.size(); ++i) {
+    const Collider& collider = m_colliders[i];
+    auto proxy = m_proxies.find(collider.entity.id().id());
+    if (proxy == m_proxies.end()) {
+      proxy = m_proxies.emplace(collider.entity.id().id(), m_sweepAndPrune.insert(collider.aabb))
+                  .first;
+    } else {
+      m_sweepAndPrune.move(proxy->second, collider.aabb);
+    }
+    if (proxy->second >= m_proxyColliders.size()) {
+      m_proxyColliders.resize(proxy->second + 1, NoCollider);
+    }
+    m_proxyColliders[proxy->second] = i;
+  }
+  m_sweepAndPrune.update();
+  m_sweepAndPrune.findPairs(m_proxyPairs);
+  m_pairs.clear();
+  for (auto& pair : m_proxyPairs) {
+    // entities with invalid coordinates keep their last bounding box, but must not collide
+    size_t a = m_proxyColliders[pair.first];
+    size_t b = m_proxyColliders[pair.second];
+    if (a != NoCollider && b != NoCollider) {
+      m_pairs.emplace_back(std::min(a, b), std::max(a, b));
+    }
+  }
+  std::sort(begin(m_pairs), end(m_pairs));
+}
+
+void Collision::removeProxy(entityx::Entity::Id id) {
+  auto proxy = m_proxies.find(id.id());
+  if (proxy != m_proxies.end()) {
+    m_sweepAndPrune.remove(proxy->second);
+    m_proxies.erase(proxy);
+  }
+}
+
+bool Collision::isTranslation(const sf::Transform& transform) {
+  const float* m = transform.getMatrix();
+  const float epsilon = 1e-4f;
+  return std::abs(m[0] - 1) < epsilon && std::abs(m[5] - 1) < epsilon &&
+         std::abs(m[1]) < epsilon && std::abs(m[4]) < epsilon;
+}
+
+void Collision::narrowphase(const Collider& a, const Collider& b, entityx::EventManager& events) {
+  const components::SpatialSnapshot& currentA = a.spatial->current();
+  const components::SpatialSnapshot& currentB = b.spatial->current();
+  size_t steps = 1;
+  float extent = std::min(a.extent, b.extent);
+  if ((a.fast || b.fast) && extent > 0) {
+    // the relative path is sampled densely enough that neither mask can skip the other
+    float distance = math::vector::length(a.displacement - b.displacement);
+    steps = static_cast<size_t>(std::ceil(2 * distance / extent));
+    steps = std::min(std::max<size_t>(steps, 1), MaxSweepSteps);
+  }
+  // a contact persisting from the previous step is no new impact, it is reported at the end
+  if (steps > 1 && overlapAt(a, b, a.spatial->previous(), b.spatial->previous()).count == 0) {
+    for (size_t step = 1; step < steps; ++step) {
+      float time = static_cast<float>(step) / static_cast<float>(steps);
+      components::SpatialSnapshot spatialA =
+          components::lerp(a.spatial->previous(), currentA, time);
+      components::SpatialSnapshot spatialB =
+          components::lerp(b.spatial->previous(), currentB, time);
+      collision::Overlap overlap = overlapAt(a, b, spatialA, spatialB);
+      if (overlap.count > 0) {
+        // the contact is found at the overlapping sample, the impact at the last free one
+        float lastFree = static_cast<float>(step - 1) / static_cast<float>(steps);
+        reportOverlap(a, b, spatialA, spatialB, overlap, lastFree, events);
+        return;
       }
-    });
+    }
+  }
+  collision::Overlap overlap = overlapAt(a, b, currentA, currentB);
+  if (overlap.count > 0) {
+    reportOverlap(a, b, currentA, currentB, overlap, 1, events);
+  }
+}
+
+octo::game::collision::Overlap Collision::overlapAt(const Collider& a, const Collider& b,
+                                                    const components::SpatialSnapshot& spatialA,
+                                                    const components::SpatialSnapshot& spatialB) {
+  const components::CollisionMask& maskA = *a.mask;
+  const components::CollisionMask& maskB = *b.mask;
+
+  // setup transformation from A's pixels to B's pixels
+  sf::Transform atob =
+      collision::globalToMask(spatialB, maskB) * collision::maskToGlobal(spatialA, maskA);
+
+  sf::Transform btoa{atob.getInverse()};
+
+  // first check AABB
+  sf::Rect<size_t> pixRectA{{0, 0}, maskA.mask().size()};
+  sf::Rect<size_t> pixRectB{{0, 0}, maskB.mask().size()};
+  sf::FloatRect pixRectAtoB = atob.transformRect(math::rect::rect_cast<float>(pixRectA));
+  sf::FloatRect intersection;
+  collision::Overlap overlap;
+  if (pixRectAtoB.intersects(math::rect::rect_cast<float>(pixRectB), intersection)) {
+    // if AABBs intersect, check pixels
+    sf::Rect<size_t> area = math::rect::integralOutwards<size_t>(intersection);
+    if (isTranslation(btoa)) {
+      // with equal rotations, whole words of pixels can be compared at once
+      sf::Vector2f offset = btoa.transformPoint(0, 0);
+      overlap = collision::overlap(
+          maskA.solidity(),
+          maskA.occupancy(),
+          maskB.solidity(),
+          maskB.occupancy(),
+          {static_cast<std::ptrdiff_t>(std::round(offset.x)),
+           static_cast<std::ptrdiff_t>(std::round(offset.y))});
+    } else {
+      // only the non-empty blocks of B mapped onto non-empty regions of A are checked pixel by pixel
+      auto visit = [&](const sf::Rect<size_t>& block, collision::Occupancy occupancy, bool leaf) {
+        sf::FloatRect blockA = btoa.transformRect(
+            {static_cast<float>(block.left), static_cast<float>(block.top),
+             static_cast<float>(block.width - 1), static_cast<float>(block.height - 1)});
+        // the pixels are rounded to the nearest pixel of A, allow one more for inaccuracies
+        auto left = static_cast<std::ptrdiff_t>(std::floor(blockA.left - 0.5f)) - 1;
+        auto top = static_cast<std::ptrdiff_t>(std::floor(blockA.top - 0.5f)) - 1;
+        auto right = static_cast<std::ptrdiff_t>(std::ceil(blockA.left + blockA.width + 0.5f)) + 1;
+        auto bottom = static_cast<std::ptrdiff_t>(std::ceil(blockA.top + blockA.height + 0.5f)) + 1;
+        collision::Occupancy other = maskA.occupancy().region({left, top, right - left, bottom - top});
+        if (other == collision::Occupancy::Empty) {
+          return false;
+        }
+        if (other == collision::Occupancy::Full && occupancy == collision::Occupancy::Full) {
+          collision::addRect(overlap, block);
+          return false;
+        }
+        if (!leaf) {
+          return true;
+        }
+        collision::addOverlap(maskA.mask(), maskB.solidity(), btoa, block, overlap);
+        return false;
+      };
+      maskB.occupancy().descend(area, visit);
+    }
+  }
+  m_world.statistics().count(Statistics::Counter::PixelsTested, overlap.tested);
+  return overlap;
+}
+
+void Collision::reportOverlap(const Collider& a, const Collider& b,
+                              const components::SpatialSnapshot& spatialA,
+                              const components::SpatialSnapshot& spatialB,
+                              const collision::Overlap& overlap, float time,
+                              entityx::EventManager& events) {
+  const components::CollisionMask& maskA = *a.mask;
+  const components::CollisionMask& maskB = *b.mask;
+  // average of overlapping pixels
+  sf::Vector2f contactPoint = collision::maskToGlobal(spatialB, maskB).transformPoint(
+      math::vector::vector_cast<float>(overlap.sum / static_cast<double>(overlap.count)));
+  sf::Vector2f contactA = collision::globalToMask(spatialA, maskA).transformPoint(contactPoint);
+  sf::Vector2f contactB = collision::globalToMask(spatialB, maskB).transformPoint(contactPoint);
+  sf::Vector2f normalA = math::vector::rotate(
+      spatialA.rotationRadians(), collision::computeNormal(maskA, m_normalAccuracy, contactA));
+  sf::Vector2f normalB = math::vector::rotate(
+      spatialB.rotationRadians(), collision::computeNormal(maskB, m_normalAccuracy, contactB));
+  emitCollision(a, b, normalA, normalB, contactPoint, time, events);
+}
+
+void Collision::traceNarrowphase(const Collider& projectile, const Collider& other,
+                                 entityx::EventManager& events) {
+  const components::CollisionMask& mask = *other.mask;
+  const collision::BitMask& solidity = mask.solidity();
+  const int width = static_cast<int>(solidity.width());
+  const int height = static_cast<int>(solidity.height());
+
+  auto isSolid = [&](int x, int y) {
+    return x >= 0 && y >= 0 && x < width && y < height &&
+           solidity.test(static_cast<size_t>(x), static_cast<size_t>(y));
+  };
+
+  // the path is traced relative to the other entity, whose motion is part of it
+  const components::SpatialSnapshot& previousOther = other.spatial->previous();
+  const components::SpatialSnapshot& currentOther = other.spatial->current();
+  sf::Vector2f end = collision::globalToMask(currentOther, mask)
+                         .transformPoint(projectile.spatial->current().position);
+  sf::Vector2f start = end;
+  if (projectile.hitbox == components::Projectile::Hitbox::Segment) {
+    start = collision::globalToMask(previousOther, mask)
+                .transformPoint(projectile.spatial->previous().position);
+    // a contact persisting from the previous step is no new impact, it is reported at the end
+    if (isSolid(static_cast<int>(std::round(start.x)), static_cast<int>(std::round(start.y)))) {
+      start = end;
+    }
+  }
+
+  // every step of the line moves by one pixel along one axis
+  const float length = std::abs(std::round(end.x) - std::round(start.x)) +
+                       std::abs(std::round(end.y) - std::round(start.y));
+  size_t tested = 0;
+  bool hit = false;
+  sf::Vector2i pixel = collision::bresenhamLine(start, end, [&](int x, int y) {
+    ++tested;
+    hit = isSolid(x, y);
+    return !hit;
   });
+  m_world.statistics().count(Statistics::Counter::PixelsTested, tested);
+  if (!hit) {
+    return;
+  }
+
+  // the solid pixel is reached one step after the last free one
+  auto fraction = [length](size_t steps) {
+    return length > 0 ? std::min(static_cast<float>(steps) / length, 1.f) : 1.f;
+  };
+  float time = fraction(std::max<size_t>(tested, 2) - 2);
+  components::SpatialSnapshot contactOther =
+      components::lerp(previousOther, currentOther, fraction(tested - 1));
+  sf::Vector2f contactLocal = math::vector::vector_cast<float>(pixel);
+  sf::Vector2f contactPoint =
+      collision::maskToGlobal(contactOther, mask).transformPoint(contactLocal);
+  sf::Vector2f normalOther =
+      math::vector::rotate(contactOther.rotationRadians(),
+                           collision::computeNormal(mask, m_normalAccuracy, contactLocal));
+  emitCollision(projectile, other, -normalOther, normalOther, contactPoint, time, events);
 }
 
+void Collision::emitCollision(const Collider& a, const Collider& b, const sf::Vector2f& normalA,
+                              const sf::Vector2f& normalB, const sf::Vector2f& contactPoint,
+                              float time, entityx::EventManager& events) {
+  if (b.entity < a.entity) {
+    emitCollision(b, a, normalB, normalA, contactPoint, time, events);
+    return;
+  }
+  log.debug("collision [%s] and [%s] at (%.1f, %.1f) after %.2f of the step; "
+            "normals (%.2f, %.2f) and (%.2f, %.2f)",
+            a.entity.id(),
+            b.entity.id(),
+            contactPoint.x,
+            contactPoint.y,
+            time,
+            normalA.x,
+            normalA.y,
+            normalB.x,
+            normalB.y);
+  events::EntityCollision collisionData(
+      {a.entity, b.entity}, {normalA, normalB}, contactPoint, time);
+  events.emit(collisionData);
+  m_world.statistics().count(Statistics::Counter::CollisionEvents);
+}
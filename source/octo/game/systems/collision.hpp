@@ -1,31 +1,197 @@
 #pragma once
 
+#include "../collision/spatialhash.hpp"
+#include "../collision/sweepandprune.hpp"
+#include "../components/collisionmask.hpp"
 #include "../components/spatial.hpp"
 #include "../components/dynamicbody.hpp"
+#include "../components/projectile.hpp"
 #include "../events/entitycollision.hpp"
 #include "../world.hpp"
+#include "../scheduler.hpp"
 
 #include <fmtlog/fmtlog.hpp>
 
 #include <entityx/entityx.h>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Transform.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace octo {
 namespace game {
 namespace systems {
 
 /*! \brief This system detects collisions between entities.
+ *
+ *  The detection runs in two phases. First, the broadphase determines the pairs of entities
+ *  whose world space bounding boxes overlap. Only those pairs are then checked pixel by pixel
+ *  in the narrowphase.
+ *
+ *  Colliders moving farther than the smaller side of their mask in a step would skip thin
+ *  obstacles. Their paths are swept by checking several interpolated positions, and the
+ *  collision is reported at the earliest one that overlaps.
+ *
+ *  Projectiles with a \ref components::Projectile::Hitbox other than the mask are tested
+ *  against other entities by tracing their position or path through the other entity's mask.
+ *
+ *  The \ref Broadphase::SweepAndPrune broadphase keeps its state between updates. Entities are
+ *  registered when they are first seen and unregistered when their collision mask is removed
+ *  or they are destroyed.
  */
-struct Collision : public entityx::System<Collision> {
+struct Collision : public entityx::System<Collision>, public entityx::Receiver<Collision> {
+  /// Available strategies for finding candidate pairs.
+  enum class Broadphase {
+    /// Every pair of entities is a candidate.
+    BruteForce,
+    /// Only entities sharing a cell of a collision::SpatialHash are candidates.
+    SpatialHash,
+    /// Only entities whose bounding boxes overlap according to a collision::SweepAndPrune are candidates.
+    SweepAndPrune,
+  };
+
   Collision(World& world);
 
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
+  /*! \brief Subscribes to the removal of \ref components::CollisionMask components and entities.
+   */
+  void configure(entityx::EventManager& events) override;
+
+  void receive(const entityx::ComponentRemovedEvent<components::CollisionMask>& event);
+
+  void receive(const entityx::EntityDestroyedEvent& event);
+
   /*! \brief Detects collisions and raises the corresponding \ref events::EntityCollision events.
    */
   void update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) override;
 
+  /// the strategy used for finding candidate pairs
+  Broadphase broadphase() const;
+
+  /// sets the strategy used for finding candidate pairs
+  void setBroadphase(Broadphase broadphase);
+
+private:
+  /// An entity participating in collision detection in the current update.
+  struct Collider {
+    entityx::Entity entity;
+    components::Spatial* spatial;
+    components::CollisionMask* mask;
+    /// the transformation from mask pixels to world coordinates
+    sf::Transform maskToGlobal{};
+    /// the bounding box of the collision mask in world coordinates, including the path of segments
+    sf::FloatRect aabb{};
+    /// how the entity is tested against other entities
+    components::Projectile::Hitbox hitbox = components::Projectile::Hitbox::Mask;
+    /// the movement of the entity in the last step
+    sf::Vector2f displacement{};
+    /// the smaller side of the collision mask
+    float extent = 0;
+    /// whether the collider moved farther than its extent, its path is swept
+    bool fast = false;
+  };
+
+  /// Collects all entities with a collision mask into \ref m_colliders.
+  void gatherColliders(entityx::EntityManager& es);
+
+  /// Fills \ref m_pairs with every pair of colliders.
+  void findPairsBruteForce();
+
+  /// Fills \ref m_pairs with the colliders sharing a cell of the spatial hash.
+  void findPairsSpatialHash();
+
+  /// Updates the sweep and prune broadphase and fills \ref m_pairs with its overlapping colliders.
+  void findPairsSweepAndPrune();
+
+  /// Unregisters an entity from the sweep and prune broadphase, if it is registered.
+  void removeProxy(entityx::Entity::Id id);
+
+  /*! \brief Checks whether a transformation between two masks consists of a translation only.
+   *
+   *  This is the case when both entities have the same rotation.
+   */
+  static bool isTranslation(const sf::Transform& transform);
+
+  /*! \brief Checks two colliders pixel by pixel and emits an event if they collide.
+   *
+   *  If either collider is fast, positions along the last step are checked in order as well.
+   *  The time of impact is then the last checked position without overlap.
+   *
+   *  \param a the first collider, its entity must be less than the entity of \p b.
+   *  \param b the second collider.
+   *  \param events the event manager receiving the collision event.
+   */
+  void narrowphase(const Collider& a, const Collider& b, entityx::EventManager& events);
+
+  /*! \brief Computes the overlap of two colliders at given positions.
+   *
+   *  \returns the overlapping pixels in the pixel coordinates of \p b.
+   */
+  collision::Overlap overlapAt(const Collider& a, const Collider& b,
+                               const components::SpatialSnapshot& spatialA,
+                               const components::SpatialSnapshot& spatialB);
+
+  /*! \brief Derives the contact and normals of an overlap and emits a collision event.
+   *
+   *  \param a the first collider, its entity must be less than the entity of \p b.
+   *  \param b the second collider.
+   *  \param spatialA the position of \p a the overlap was computed at.
+   *  \param spatialB the position of \p b the overlap was computed at.
+   *  \param overlap the non-empty overlap returned by \ref overlapAt.
+   *  \param time the time of impact as a fraction of the last step, the positions may lie later.
+   *  \param events the event manager receiving the collision event.
+   */
+  void reportOverlap(const Collider& a, const Collider& b,
+                     const components::SpatialSnapshot& spatialA,
+                     const components::SpatialSnapshot& spatialB,
+                     const collision::Overlap& overlap, float time,
+                     entityx::EventManager& events);
+
+  /*! \brief Traces the position or path of a projectile through another collider's mask.
+   *
+   *  The contact is the first solid pixel on the path. The time of impact is the fraction of the
+   *  path leading to the last free pixel before it, so a projectile moved back to it ends up
+   *  outside of the surface. The path is traced relative to the other entity, so the time of
+   *  impact holds for the motion of both.
+   *  The normal of the projectile faces the normal of the surface it hits.
+   *
+   *  \param projectile the collider whose hitbox is a point or a segment.
+   *  \param other the collider tested by its mask.
+   *  \param events the event manager receiving the collision event.
+   */
+  void traceNarrowphase(const Collider& projectile, const Collider& other,
+                        entityx::EventManager& events);
+
+  /*! \brief Emits a collision event for two colliders, ordered by their entities.
+   */
+  void emitCollision(const Collider& a, const Collider& b, const sf::Vector2f& normalA,
+                     const sf::Vector2f& normalB, const sf::Vector2f& contactPoint, float time,
+                     entityx::EventManager& events);
+
 private:
   fmtlog::Log log = fmtlog::For<Collision>();
   World& m_world;
   int m_normalAccuracy = 4;
+
+  Broadphase m_broadphase = Broadphase::SpatialHash;
+  collision::SpatialHash m_spatialHash;
+  collision::SweepAndPrune m_sweepAndPrune;
+  /// the proxies of the entities registered in \ref m_sweepAndPrune, by entity id
+  std::unordered_map<std::uint64_t, collision::SweepAndPrune::Proxy> m_proxies;
+  /// the index into \ref m_colliders of every proxy, or the maximum size_t if it has no collider currently
+  std::vector<size_t> m_proxyColliders;
+  /// the overlapping proxies reported by \ref m_sweepAndPrune
+  std::vector<std::pair<collision::SweepAndPrune::Proxy, collision::SweepAndPrune::Proxy>> m_proxyPairs;
+  /// the colliders of the current update
+  std::vector<Collider> m_colliders;
+  /// the candidate pairs of the current update, indices into \ref m_colliders
+  std::vector<std::pair<size_t, size_t>> m_pairs;
 };
 
 }
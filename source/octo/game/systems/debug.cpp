@@ -1,16 +1,45 @@
 #include "debug.hpp"
 
+#include <octo/math/rect.hpp>
+
+#include <memory>
+
 namespace octo {
 namespace game {
 namespace systems {
 
+namespace {
+sf::Color debugMaskColor(collision::Pixel pix) {
+  return pix == collision::Pixel::NoCollision ? sf::Color::Transparent : sf::Color::White;
+}
+}
+
 void Debug::configure(entityx::EventManager& events) {
   events.subscribe<events::ComponentModified<components::CollisionMask>>(*this);
   events.subscribe<entityx::ComponentAddedEvent<components::CollisionMask>>(*this);
   events.subscribe<entityx::EntityCreatedEvent>(*this);
 }
 
+SystemAccess Debug::access() {
+  using namespace components;
+  return SystemAccess()
+      .receives<entityx::EntityCreatedEvent,
+                entityx::ComponentAddedEvent<CollisionMask>,
+                events::ComponentModified<CollisionMask>>()
+      .reads<CollisionMask>()
+      .writes<DebugData>();
+}
+
 void Debug::update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) {
+  for (auto& modified : m_modifiedMasks) {
+    entityx::Entity entity = modified.first;
+    if (entity.valid()) {
+      updateCollisionMask(entity.component<components::CollisionMask>(),
+                          entity.component<components::DebugData>(),
+                          modified.second);
+    }
+  }
+  m_modifiedMasks.clear();
 }
 
 void Debug::receive(const entityx::EntityCreatedEvent& event) {
@@ -19,24 +48,61 @@ void Debug::receive(const entityx::EntityCreatedEvent& event) {
 }
 
 void Debug::receive(const entityx::ComponentAddedEvent<components::CollisionMask>& event) {
-  updateCollisionMask(event.component, entityx::Entity(event.entity).component<components::DebugData>());
+  updateCollisionMask(
+      event.component, entityx::Entity(event.entity).component<components::DebugData>(), {});
 }
 
 void Debug::receive(const events::ComponentModified<components::CollisionMask>& event) {
-  updateCollisionMask(event.component, entityx::Entity(event.entity).component<components::DebugData>());
+  // the event may be emitted on a worker thread, the image is updated in update()
+  events::mergeModified(m_modifiedMasks, event);
 }
 
 void Debug::updateCollisionMask(entityx::ComponentHandle<components::CollisionMask> collision,
-                         entityx::ComponentHandle<components::DebugData> debugData) {
+                                entityx::ComponentHandle<components::DebugData> debugData,
+                                const sf::Rect<size_t>& region) {
   // make sure the component is still valid by the time the event arrives
-  if(collision.valid() && debugData.valid()) {
-    auto debugMaskConverter = [](game::collision::Pixel pix) {
-      return pix == game::collision::Pixel::NoCollision ? sf::Color::Transparent : sf::Color::White;
-    };
+  if (!collision.valid() || !debugData.valid()) {
+    return;
+  }
+  const collision::Mask& mask = collision->mask();
+  const std::shared_ptr<const components::MaskImage>& previous = debugData->collisionMaskImage;
 
-    sf::Image img { collision->mask.toImage(debugMaskConverter) };
-    debugData->collisionMaskTexture.loadFromImage(img);
+  if (!collision->ownsShape()) {
+    // shared shapes never change, their image is created once
+    auto& shared = m_sharedImages[collision->shape()];
+    debugData->collisionMaskImage = shared.lock();
+    if (!debugData->collisionMaskImage) {
+      auto image = std::make_shared<components::MaskImage>();
+      image->image = mask.toImage(debugMaskColor);
+      shared = image;
+      debugData->collisionMaskImage = std::move(image);
+    }
+    return;
+  }
+
+  // the new image is derived from the previous one, so that consumers can update incrementally
+  auto image = std::make_shared<components::MaskImage>();
+  sf::Rect<size_t> changed;
+  const sf::Rect<size_t> bounds{{0, 0}, mask.size()};
+  if (previous && previous->image.getSize() == sf::Vector2u(mask.size()) &&
+      region.intersects(bounds, changed)) {
+    image->image = previous->image;
+    for (size_t y = changed.top; y < changed.top + changed.height; ++y) {
+      for (size_t x = changed.left; x < changed.left + changed.width; ++x) {
+        image->image.setPixel(x, y, debugMaskColor(mask.at(x, y)));
+      }
+    }
+  } else {
+    image->image = mask.toImage(debugMaskColor);
+    changed = bounds;
+  }
+  if (previous) {
+    image->revision = previous->revision + 1;
+    image->changes = previous->changes;
   }
+  image->changes[image->revision % components::MaskImage::History] =
+      math::rect::rect_cast<unsigned>(changed);
+  debugData->collisionMaskImage = std::move(image);
 }
 
 }
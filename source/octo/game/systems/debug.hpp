@@ -2,9 +2,13 @@
 
 #include "../components.hpp"
 #include "../events/componentmodified.hpp"
+#include "../scheduler.hpp"
 
 #include <entityx/entityx.h>
 
+#include <map>
+#include <memory>
+
 namespace octo {
 namespace game {
 namespace systems {
@@ -13,6 +17,9 @@ struct Debug : public entityx::System<Debug>, public entityx::Receiver<Debug> {
 
   void configure(entityx::EventManager& events) override;
 
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
   void update(entityx::EntityManager& es, entityx::EventManager& events,
               entityx::TimeDelta dt) override;
 
@@ -23,8 +30,20 @@ struct Debug : public entityx::System<Debug>, public entityx::Receiver<Debug> {
   void receive(const entityx::ComponentAddedEvent<components::CollisionMask>& event);
 
 private:
+  /*! \brief Replaces the image of a collision mask.
+   *  \param region the pixels changed since the previous image, empty if unknown.
+   */
   void updateCollisionMask(entityx::ComponentHandle<components::CollisionMask> collision,
-                           entityx::ComponentHandle<components::DebugData> debugData);
+                           entityx::ComponentHandle<components::DebugData> debugData,
+                           const sf::Rect<size_t>& region);
+
+  /// entities whose collision mask changed since the last update, with the changed pixels
+  events::ModifiedRegions m_modifiedMasks;
+  /// the images of shared shapes, so that entities sharing a shape share the image as well
+  std::map<std::weak_ptr<const collision::Shape>,
+           std::weak_ptr<const components::MaskImage>,
+           std::owner_less<std::weak_ptr<const collision::Shape>>>
+      m_sharedImages;
 };
 }
 }
@@ -1,11 +1,11 @@
 #include "explosions.hpp"
 
+#include <octo/game/collision/carve.hpp>
 #include <octo/game/collision/util.hpp>
 #include <octo/game/events/componentmodified.hpp>
 #include <octo/game/events/damage.hpp>
 #include <octo/game/components.hpp>
 #include <octo/math/all.hpp>
-#include <octo/util/rectiterator.hpp>
 
 #include <SFML/Graphics/Rect.hpp>
 
@@ -16,43 +16,37 @@ namespace octo {
 namespace game {
 namespace systems {
 
-Explosions::Explosions() {}
+Explosions::Explosions(World& world) : m_world(world) {}
 
 void Explosions::configure(entityx::EventManager& events) {
   events.subscribe<events::Explode>(*this);
 }
 
+SystemAccess Explosions::access() {
+  using namespace components;
+  return SystemAccess()
+      .receives<events::Explode>()
+      .reads<Spatial, collision::AabbTree>()
+      .writes<CollisionMask, DynamicBody>()
+      .emits<events::Damage, events::ComponentModified<CollisionMask>>();
+}
+
 void Explosions::update(entityx::EntityManager& es, entityx::EventManager& events,
                         entityx::TimeDelta dt) {
+  m_world.statistics().count(Statistics::Counter::Explosions, m_explosions.size());
   for (auto& explosion : m_explosions) {
     log.debug("explosion at {%f, %f}", explosion.center.x, explosion.center.y);
     float queryRadius = std::max(explosion.damageRadius, explosion.destructionRadius);
     sf::FloatRect aabb =
         math::rect::fromCenterSize(explosion.center, {queryRadius * 2, queryRadius * 2});
-    float destructionRadiusSq = math::util::sqr(explosion.destructionRadius);
     collision::aabbQuery(
-        es, aabb, [&](entityx::Entity hit, const collision::AabbQueryData& result) {
+        es, m_world.aabbTree(), aabb, [&](entityx::Entity hit, const collision::AabbQueryData& result) {
           if(hit != explosion.origin) {
             log.debug("explosion hit (AABB) candidate [%s]", hit.id());
-            // transform explosion center to local coordinates once
-            sf::Vector2f localExplosionCenter = result.globalToMask.transformPoint(explosion.center);
-            // apply destruction
-            bool maskChanged = false;
-            for (auto& pos : util::rectRange(result.intersectionMask)) {
-              // the previous transform involved no scaling
-              if (math::vector::lengthSquared(localExplosionCenter -
-                                              math::vector::vector_cast<float>(pos))
-                  <= destructionRadiusSq) {
-                if(result.collisionComponent.mask.at(pos.x, pos.y) == collision::Pixel::SolidDestructible) {
-                  result.collisionComponent.mask.at(pos.x, pos.y) = collision::Pixel::NoCollision;
-                  maskChanged = true;
-                }
-              }
-            }
-            if(maskChanged) {
-              log.debug("explosion destroyed terrain [%s]", hit.id());
-              events.emit<events::ComponentModified<components::CollisionMask>>(hit);
-            }
+            // the destruction is applied once for all explosions of this step,
+            // the previous transform involved no scaling
+            m_destruction[hit].push_back(
+                {result.globalToMask.transformPoint(explosion.center), explosion.destructionRadius});
             // TODO maybe make range for applying force larger
             auto body = hit.component<components::DynamicBody>();
             if(body.valid()) {
@@ -69,12 +63,35 @@ void Explosions::update(entityx::EntityManager& es, entityx::EventManager& event
                 events.emit(events::Damage { hit, fscale * explosion.damage });
               }
             }
-
-            // TODO spawn debris
+            // the debris is spawned by the Particles system
           }
         });
   }
   m_explosions.clear();
+  destroyTerrain(events);
+}
+
+void Explosions::destroyTerrain(entityx::EventManager& events) {
+  for (auto& destruction : m_destruction) {
+    entityx::Entity hit = destruction.first;
+    // the damage of the explosions might have destroyed the entity in the meantime
+    auto collision = hit.valid() ? hit.component<components::CollisionMask>()
+                                 : entityx::ComponentHandle<components::CollisionMask>();
+    if (!collision) {
+      continue;
+    }
+    // a shared shape is only copied if the explosions actually destroy some of its pixels
+    if (!collision->ownsShape() && !collision::canCarve(collision->mask(), destruction.second)) {
+      continue;
+    }
+    sf::Rect<size_t> changed = collision::carve(collision->modifyMask(), destruction.second);
+    if (changed.width > 0) {
+      log.debug("explosion destroyed terrain [%s]", hit.id());
+      collision->update(changed);
+      events.emit<events::ComponentModified<components::CollisionMask>>(hit, changed);
+    }
+  }
+  m_destruction.clear();
 }
 
 void Explosions::receive(const events::Explode& event) {
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "../collision/carve.hpp"
 #include "../events/explode.hpp"
+#include "../world.hpp"
+#include "../scheduler.hpp"
 #include <fmtlog/fmtlog.hpp>
 #include <entityx/entityx.h>
 
+#include <map>
 #include <vector>
 
 namespace octo {
@@ -11,18 +15,31 @@ namespace game {
 namespace systems {
 
 struct Explosions : public entityx::System<Explosions>, public entityx::Receiver<Explosions> {
-  Explosions();
+  Explosions(World& world);
 
   void configure(entityx::EventManager& events) override;
 
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
   void update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) override;
 
   void receive(const events::Explode& event);
 
 private:
+  /*! \brief Destroys the terrain hit by the explosions of this step.
+   *
+   *  Each entity is modified in a single pass, emitting a single events::ComponentModified
+   *  event, no matter how many explosions hit it.
+   */
+  void destroyTerrain(entityx::EventManager& events);
+
   fmtlog::Log log = fmtlog::For<Explosions>();
+  World& m_world;
 
   std::vector<events::Explode> m_explosions;
+  /// the destruction circles of the current step in mask coordinates, by entity
+  std::map<entityx::Entity, std::vector<collision::Circle>> m_destruction;
 };
 
 }
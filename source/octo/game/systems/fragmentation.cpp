@@ -0,0 +1,143 @@
+#include "fragmentation.hpp"
+
+#include "../collision/util.hpp"
+#include "../components.hpp"
+
+#include <octo/math/rect.hpp>
+#include <octo/math/vector.hpp>
+
+namespace octo {
+namespace game {
+namespace systems {
+
+const size_t Fragmentation::MinFragmentPixels = 16;
+const size_t Fragmentation::SearchMargin = 64;
+const float Fragmentation::FragmentDensity = 0.02f;
+
+SystemAccess Fragmentation::access() {
+  using namespace components;
+  return SystemAccess()
+      .receives<events::ComponentModified<CollisionMask>>()
+      .reads<Spatial, DynamicBody, Material>()
+      .writes<CollisionMask>()
+      .emits<events::ComponentModified<CollisionMask>>()
+      .changesEntities();
+}
+
+void Fragmentation::configure(entityx::EventManager& events) {
+  events.subscribe<events::ComponentModified<components::CollisionMask>>(*this);
+}
+
+void Fragmentation::receive(const events::ComponentModified<components::CollisionMask>& event) {
+  events::mergeModified(m_modifiedMasks, event);
+}
+
+void Fragmentation::update(entityx::EntityManager& es, entityx::EventManager& events,
+                           entityx::TimeDelta dt) {
+  auto modified = std::move(m_modifiedMasks);
+  for (auto& entry : modified) {
+    entityx::Entity entity = entry.first;
+    if (entity.valid() && entity.has_component<components::CollisionMask>()) {
+      split(es, events, entity, entry.second);
+    }
+  }
+  // the modifications made by splitting never detach further pieces
+  m_modifiedMasks.clear();
+}
+
+void Fragmentation::split(entityx::EntityManager& es, entityx::EventManager& events,
+                          entityx::Entity entity, const sf::Rect<size_t>& region) {
+  auto collision = entity.component<components::CollisionMask>();
+  const sf::Rect<size_t> bounds{{0, 0}, collision->mask().size()};
+  sf::Rect<size_t> searched;
+  if (region.width == 0 || region.height == 0) {
+    searched = bounds;
+  } else if (!region.intersects(bounds, searched)) {
+    return;
+  }
+  std::vector<collision::Island> islands =
+      collision::findDetachedIslands(collision->mask(), searched, SearchMargin);
+  if (islands.empty()) {
+    return;
+  }
+
+  sf::Rect<size_t> removed;
+  for (const auto& island : islands) {
+    if (island.pixels.size() >= MinFragmentPixels) {
+      spawnFragment(es, entity, island);
+    }
+    removed = math::rect::merge(removed, island.bounds);
+  }
+  collision::Mask& mask = collision->modifyMask();
+  for (const auto& island : islands) {
+    for (size_t pixel : island.pixels) {
+      mask.at(pixel % mask.width(), pixel / mask.width()) = collision::Pixel::NoCollision;
+    }
+  }
+  log.debug("split %s pieces off [%s]", islands.size(), entity.id());
+  collision->update(removed);
+  events.emit<events::ComponentModified<components::CollisionMask>>(entity, removed);
+}
+
+void Fragmentation::spawnFragment(entityx::EntityManager& es, entityx::Entity parent,
+                                  const collision::Island& island) {
+  auto parentCollision = parent.component<components::CollisionMask>();
+  auto parentSpatial = parent.component<components::Spatial>();
+  if (!parentSpatial) {
+    return;
+  }
+  const collision::Mask& parentMask = parentCollision->mask();
+  const size_t width = parentMask.width();
+
+  // the center of mass of the piece in the parent's mask coordinates
+  sf::Vector2f center;
+  for (size_t pixel : island.pixels) {
+    center += {static_cast<float>(pixel % width), static_cast<float>(pixel / width)};
+  }
+  center /= static_cast<float>(island.pixels.size());
+  // each pixel is a unit square of uniform density
+  float inertia = static_cast<float>(island.pixels.size()) / 6;
+  collision::Mask mask(island.bounds.width, island.bounds.height);
+  for (size_t pixel : island.pixels) {
+    size_t x = pixel % width;
+    size_t y = pixel / width;
+    mask.at(x - island.bounds.left, y - island.bounds.top) = parentMask.at(x, y);
+    inertia += math::vector::lengthSquared(
+        sf::Vector2f(static_cast<float>(x), static_cast<float>(y)) - center);
+  }
+
+  // the piece keeps its place, with its origin at its center of mass
+  const components::SpatialSnapshot location = parentSpatial->current();
+  sf::Vector2f position =
+      collision::maskToGlobal(location, *parentCollision).transformPoint(center);
+  sf::Vector2f anchor = math::vector::vector_cast<float>(sf::Vector2<size_t>(
+                            island.bounds.left, island.bounds.top)) -
+                        center + 0.5f * math::vector::vector_cast<float>(mask.size());
+  float mass = FragmentDensity * static_cast<float>(island.pixels.size());
+  sf::Uint64 selector = parentCollision->selector;
+
+  entityx::Entity fragment = es.create();
+  fragment.assign<components::Spatial>(position, location.rotationDegrees);
+  auto body = fragment.assign<components::DynamicBody>();
+  body->setMass(mass);
+  body->setInertia(FragmentDensity * inertia);
+  auto parentBody = parent.component<components::DynamicBody>();
+  if (parentBody) {
+    // the piece keeps moving like the part of the parent it was
+    float angularVelocity = parentBody->angularVelocity();
+    sf::Vector2f r = position - location.position;
+    body->setVelocity(parentBody->velocity() + angularVelocity * sf::Vector2f(-r.y, r.x));
+    body->angularMomentum = body->inertia * angularVelocity;
+  }
+  fragment.assign<components::Attractable>(mass, components::Attractable::PlanetBit);
+  auto collision = fragment.assign<components::CollisionMask>(std::move(mask), anchor);
+  collision->selector = selector;
+  auto material = parent.component<components::Material>();
+  if (material) {
+    fragment.assign_from_copy(*material);
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../collision/islands.hpp"
+#include "../components/collisionmask.hpp"
+#include "../events/componentmodified.hpp"
+#include "../scheduler.hpp"
+
+#include <fmtlog/fmtlog.hpp>
+#include <entityx/entityx.h>
+
+namespace octo {
+namespace game {
+namespace systems {
+
+/*! \brief This system splits pieces off collision masks once they are no longer connected.
+ *
+ *  Whenever pixels of a \ref components::CollisionMask are removed, e.g. by explosions, the
+ *  pixels around the modified region are checked for pieces that became detached from the rest
+ *  of the mask. Such pieces are removed from the mask and spawned as debris entities with their
+ *  own tightly cropped masks, falling towards the planets. Tiny pieces are removed entirely.
+ */
+struct Fragmentation : public entityx::System<Fragmentation>,
+                       public entityx::Receiver<Fragmentation> {
+  /// pieces with fewer pixels are removed instead of becoming debris
+  static const size_t MinFragmentPixels;
+
+  /// the distance around a modified region within which detached pieces are found
+  static const size_t SearchMargin;
+
+  /// the mass of a single pixel of debris
+  static const float FragmentDensity;
+
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
+  void configure(entityx::EventManager& events) override;
+
+  void receive(const events::ComponentModified<components::CollisionMask>& event);
+
+  void update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) override;
+
+private:
+  /// Splits the detached pieces near \p region off an entity.
+  void split(entityx::EntityManager& es, entityx::EventManager& events, entityx::Entity entity,
+             const sf::Rect<size_t>& region);
+
+  /// Creates a debris entity from a piece of \p parent.
+  void spawnFragment(entityx::EntityManager& es, entityx::Entity parent,
+                     const collision::Island& island);
+
+  fmtlog::Log log = fmtlog::For<Fragmentation>();
+  /// entities whose collision mask changed since the last update, with the changed pixels
+  events::ModifiedRegions m_modifiedMasks;
+};
+
+}
+}
+}
@@ -10,6 +10,13 @@ void HealthSystem::configure(entityx::EventManager& events) {
   events.subscribe<events::Damage>(*this);
 }
 
+SystemAccess HealthSystem::access() {
+  return SystemAccess()
+      .receives<events::Damage>()
+      .writes<components::Health>()
+      .changesEntities();
+}
+
 void HealthSystem::update(entityx::EntityManager& es, entityx::EventManager& events,
             entityx::TimeDelta dt) {
 }
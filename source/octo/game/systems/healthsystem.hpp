@@ -2,6 +2,7 @@
 
 #include "../components.hpp"
 #include "../events/damage.hpp"
+#include "../scheduler.hpp"
 
 #include <fmtlog/fmtlog.hpp>
 #include <entityx/entityx.h>
@@ -17,6 +18,9 @@ struct HealthSystem : public entityx::System<HealthSystem>, public entityx::Rece
 
   void configure(entityx::EventManager& events) override;
 
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
   void update(entityx::EntityManager& es, entityx::EventManager& events,
               entityx::TimeDelta dt) override;
 
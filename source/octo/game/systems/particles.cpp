@@ -0,0 +1,134 @@
+#include "particles.hpp"
+
+#include "../collision/util.hpp"
+#include "../components.hpp"
+
+#include <octo/math/vector.hpp>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+
+namespace octo {
+namespace game {
+namespace systems {
+
+const size_t Particles::DebrisPerExplosion = 1024;
+const float Particles::DebrisSpeed = 150;
+const float Particles::DebrisLifetime = 6;
+
+Particles::Particles(World& world, const Attraction& attraction)
+    : m_world(world),
+      m_attraction(attraction),
+      m_ax(world.particles().capacity()),
+      m_ay(world.particles().capacity()) {}
+
+SystemAccess Particles::access() {
+  using namespace components;
+  return SystemAccess()
+      .receives<events::Explode>()
+      .reads<Spatial, CollisionMask, Planet>()
+      .writes<ParticlePool>();
+}
+
+void Particles::configure(entityx::EventManager& events) {
+  events.subscribe<events::Explode>(*this);
+}
+
+void Particles::receive(const events::Explode& event) {
+  m_explosions.push_back(event);
+}
+
+void Particles::update(entityx::EntityManager& es, entityx::EventManager& events,
+                       entityx::TimeDelta dt) {
+  spawnDebris();
+  ParticlePool& pool = m_world.particles();
+  const float step = static_cast<float>(dt);
+  float* x = pool.x();
+  float* y = pool.y();
+  float* vx = pool.vx();
+  float* vy = pool.vy();
+  float* lifetime = pool.lifetime();
+
+  // debris is attracted by the planets only, like the other attractables
+  m_attraction.accelerations(
+      x, y, pool.size(), components::Attractable::PlanetBit, m_ax.data(), m_ay.data());
+  const float* ax = m_ax.data();
+  const float* ay = m_ay.data();
+  for (size_t i = 0; i < pool.size(); ++i) {
+    vx[i] += ax[i] * step;
+    vy[i] += ay[i] * step;
+    x[i] += vx[i] * step;
+    y[i] += vy[i] * step;
+    lifetime[i] -= step;
+  }
+
+  gatherObstacles(es);
+  const float clipRadiusSq = m_world.clipRadius() * m_world.clipRadius();
+  for (size_t i = 0; i < pool.size();) {
+    if (lifetime[i] <= 0 || x[i] * x[i] + y[i] * y[i] > clipRadiusSq || hitsObstacle(x[i], y[i])) {
+      // the last particle takes this place and is checked next
+      pool.remove(i);
+    } else {
+      ++i;
+    }
+  }
+  m_world.statistics().count(Statistics::Counter::Particles, pool.size());
+}
+
+void Particles::spawnDebris() {
+  ParticlePool& pool = m_world.particles();
+  std::uniform_real_distribution<float> angle(0, 2 * boost::math::constants::pi<float>());
+  std::uniform_real_distribution<float> fraction(0, 1);
+  for (const auto& explosion : m_explosions) {
+    for (size_t i = 0; i < DebrisPerExplosion; ++i) {
+      float a = angle(m_random);
+      sf::Vector2f direction{std::cos(a), std::sin(a)};
+      // the debris starts within the crater, which has already been carved out
+      sf::Vector2f position =
+          explosion.center + direction * (0.5f * explosion.destructionRadius * fraction(m_random));
+      sf::Vector2f velocity = direction * (DebrisSpeed * (0.2f + 0.8f * fraction(m_random)));
+      if (!pool.spawn(position, velocity, DebrisLifetime * (0.5f + 0.5f * fraction(m_random)))) {
+        break;
+      }
+    }
+  }
+  m_explosions.clear();
+}
+
+void Particles::gatherObstacles(entityx::EntityManager& es) {
+  using namespace components;
+  m_obstacles.clear();
+  es.each<Spatial, CollisionMask, Planet>(
+      [this](entityx::Entity, Spatial& spatial, CollisionMask& mask, Planet&) {
+        Obstacle obstacle;
+        obstacle.globalToMask = collision::globalToMask(spatial.current(), mask);
+        obstacle.center = collision::maskToGlobal(spatial.current(), mask)
+                              .transformPoint(0.5f * mask.size());
+        obstacle.radiusSq = 0.25f * math::vector::lengthSquared(mask.size());
+        obstacle.solidity = &mask.solidity();
+        m_obstacles.push_back(obstacle);
+      });
+}
+
+bool Particles::hitsObstacle(float x, float y) const {
+  for (const auto& obstacle : m_obstacles) {
+    float dx = x - obstacle.center.x;
+    float dy = y - obstacle.center.y;
+    if (dx * dx + dy * dy > obstacle.radiusSq) {
+      continue;
+    }
+    sf::Vector2f p = obstacle.globalToMask.transformPoint(x, y);
+    float px = std::round(p.x);
+    float py = std::round(p.y);
+    if (px >= 0 && py >= 0 && px < obstacle.solidity->width() && py < obstacle.solidity->height() &&
+        obstacle.solidity->test(static_cast<size_t>(px), static_cast<size_t>(py))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}
+}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../events/explode.hpp"
+#include "../particlepool.hpp"
+#include "../scheduler.hpp"
+#include "../world.hpp"
+#include "attractionsystem.hpp"
+
+#include <entityx/entityx.h>
+#include <SFML/Graphics/Transform.hpp>
+
+#include <random>
+#include <vector>
+
+namespace octo {
+namespace game {
+namespace systems {
+
+/*! \brief This system simulates the debris particles of the World's ParticlePool.
+ *
+ *  Every explosion throws out a burst of debris. The particles are attracted by the planets
+ *  just like entities, see Attraction::accelerations, but do not collide with each other or
+ *  with entities. A particle vanishes when it hits the terrain of a planet, leaves the world
+ *  or reaches the end of its lifetime. Particles are only tested as single points against
+ *  the planet masks.
+ */
+struct Particles : public entityx::System<Particles>, public entityx::Receiver<Particles> {
+  /// the number of debris particles thrown out by an explosion
+  static const size_t DebrisPerExplosion;
+
+  /// the maximum speed of debris particles in world units per second
+  static const float DebrisSpeed;
+
+  /// the maximum lifetime of debris particles in seconds
+  static const float DebrisLifetime;
+
+  /*! \brief Initializes the system.
+   *  \param world the world owning the particle pool.
+   *  \param attraction the system providing the gravity, it must run before this one.
+   */
+  Particles(World& world, const Attraction& attraction);
+
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
+  void configure(entityx::EventManager& events) override;
+
+  void receive(const events::Explode& event);
+
+  void update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) override;
+
+private:
+  /// A planet mask gathered for testing the particles against.
+  struct Obstacle {
+    /// the transformation from world to mask pixel coordinates
+    sf::Transform globalToMask;
+    /// the center of the bounding circle in world coordinates
+    sf::Vector2f center;
+    /// the squared radius of the bounding circle
+    float radiusSq;
+    const collision::BitMask* solidity;
+  };
+
+  /// Spawns the debris of the explosions received since the last update.
+  void spawnDebris();
+
+  /// Collects the masks of all planets into \ref m_obstacles.
+  void gatherObstacles(entityx::EntityManager& es);
+
+  /// whether a point is within a solid pixel of any obstacle
+  bool hitsObstacle(float x, float y) const;
+
+  World& m_world;
+  const Attraction& m_attraction;
+  std::vector<events::Explode> m_explosions;
+  std::vector<Obstacle> m_obstacles;
+  /// the accelerations of the particles, allocated once for the capacity of the pool
+  std::vector<float> m_ax;
+  std::vector<float> m_ay;
+  std::minstd_rand m_random;
+};
+
+}
+}
+}
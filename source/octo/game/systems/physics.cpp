@@ -5,17 +5,54 @@
 
 #include <boost/math/constants/constants.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 using namespace octo::game::systems;
 
 Physics::Physics(World& world) : m_world(world) {}
 
+octo::game::SystemAccess Physics::access() {
+  using namespace components;
+  return SystemAccess().writes<Spatial, DynamicBody>().receives<events::EntityCollision>();
+}
+
+void Physics::configure(entityx::EventManager& events) {
+  events.subscribe<events::EntityCollision>(*this);
+}
+
+void Physics::receive(const events::EntityCollision& event) {
+  if (event.timeOfImpact >= 1) {
+    return;
+  }
+  for (auto& entity : event.entities) {
+    auto impact = m_impacts.emplace(entity, event.timeOfImpact).first;
+    impact->second = std::min(impact->second, event.timeOfImpact);
+  }
+}
+
 void Physics::update(entityx::EntityManager& es, entityx::EventManager&, entityx::TimeDelta dt) {
   float timeStep = static_cast<float>(dt);
+  rewind();
   integrate(es, timeStep);
 }
 
+void Physics::rewind() {
+  using namespace components;
+  for (auto& impact : m_impacts) {
+    entityx::Entity entity = impact.first;
+    // projectiles might have been destroyed on impact
+    if (!entity.valid() || !entity.has_component<DynamicBody>()) {
+      continue;
+    }
+    auto spatial = entity.component<Spatial>();
+    if (spatial) {
+      spatial->current() = lerp(spatial->previous(), spatial->current(), impact.second);
+    }
+  }
+  m_impacts.clear();
+}
+
 void Physics::integrate(entityx::EntityManager& es, float timeStep) {
   using namespace components;
   es.each<Spatial, DynamicBody>(
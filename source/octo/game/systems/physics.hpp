@@ -2,11 +2,15 @@
 
 #include "../components/spatial.hpp"
 #include "../components/dynamicbody.hpp"
+#include "../events/entitycollision.hpp"
 #include "../world.hpp"
+#include "../scheduler.hpp"
 #include <fmtlog/fmtlog.hpp>
 
 #include <entityx/entityx.h>
 
+#include <map>
+
 namespace octo {
 namespace game {
 namespace systems {
@@ -14,10 +18,23 @@ namespace systems {
 /*! \brief Responsible for updating the moving parts of the simulation and performs physics related computations.
  *
  *  In this system, forces are converted into motion using a semi-implicit Euler integration.
+ *
+ *  Bodies that collided during their last step, as reported by an \ref events::EntityCollision
+ *  with a time of impact before the end of the step, are moved back to the position of the
+ *  impact before integrating. Hence fast bodies do not end up behind thin obstacles.
  */
-struct Physics : public entityx::System<Physics> {
+struct Physics : public entityx::System<Physics>, public entityx::Receiver<Physics> {
   Physics(World& world);
 
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
+  /*! \brief Subscribes to \ref events::EntityCollision events.
+   */
+  void configure(entityx::EventManager& events) override;
+
+  void receive(const events::EntityCollision& event);
+
   /*! \brief Performs physics calculations.
    *  \param es the entity system involved,
    *  \param events (currently) unused,
@@ -26,6 +43,10 @@ struct Physics : public entityx::System<Physics> {
   void update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) override;
 
 private:
+  /*! \brief Moves the bodies that collided during the last step back to their earliest impact.
+   */
+  void rewind();
+
   /*! \brief Semi-implicit euler integration of movements.
    *  \brief es Entity manager.
    *  \brief timeStep The time in seconds since the last update.
@@ -35,6 +56,8 @@ private:
 private:
   fmtlog::Log log = fmtlog::For<Physics>();
   World& m_world;
+  /// the earliest time of impact of every entity that collided during the last step
+  std::map<entityx::Entity, float> m_impacts;
 };
 
 }
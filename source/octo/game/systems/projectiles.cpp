@@ -20,6 +20,15 @@ void Projectiles::configure(entityx::EventManager& events) {
   events.subscribe<events::EntityCollision>(*this);
 }
 
+SystemAccess Projectiles::access() {
+  using namespace components;
+  return SystemAccess()
+      .receives<events::EntityCollision>()
+      .reads<Spatial, DynamicBody, Projectile>()
+      .emits<events::Damage, events::Explode>()
+      .changesEntities();
+}
+
 void Projectiles::update(entityx::EntityManager& es, entityx::EventManager& events,
                          entityx::TimeDelta dt) {
   for (auto& hit : m_projectileHits) {
@@ -30,7 +39,7 @@ void Projectiles::update(entityx::EntityManager& es, entityx::EventManager& even
       // FIXME: conversion [energy] -> [damage] is missing
       events.emit(events::Damage { hit.entities[1], 0.01f * kineticEnergy });
 
-      triggerProjectile(events, hit.entities[0]);
+      triggerProjectile(events, hit.entities[0], hit.timeOfImpact);
     }
   }
   m_projectileHits.clear();
@@ -38,7 +47,7 @@ void Projectiles::update(entityx::EntityManager& es, entityx::EventManager& even
   for (auto& coll : m_projectileCollisions) {
     for (auto& e : coll.entities) {
       if (e.valid()) {
-        triggerProjectile(events, e);
+        triggerProjectile(events, e, coll.timeOfImpact);
       }
     }
   }
@@ -64,13 +73,16 @@ bool Projectiles::isProjectile(entityx::Entity entity) {
 }
 
 void Projectiles::triggerProjectile(entityx::EventManager& events,
-                                    entityx::Entity projectileEntity) {
+                                    entityx::Entity projectileEntity, float timeOfImpact) {
   auto spatial = projectileEntity.component<components::Spatial>();
   auto projectile = projectileEntity.component<components::Projectile>();
   if (spatial.valid() && projectile.valid()) {
     log.debug("triggering projectile %s explosion radius %.0f", projectileEntity, projectile->explosionRadius);
     // TODO replace with scriptable effects
-    events.emit<events::Explode>(projectileEntity, spatial->current().position, projectile->explosionRadius,
+    // fast projectiles explode where they hit, not behind the obstacle
+    sf::Vector2f position =
+        components::lerp(spatial->previous(), spatial->current(), timeOfImpact).position;
+    events.emit<events::Explode>(projectileEntity, position, projectile->explosionRadius,
                                  projectile->explosionRadius * 1.5, 100, 1);
     projectile->bounceCounter += 1;
     if(projectile->bounceCounter > 3) {
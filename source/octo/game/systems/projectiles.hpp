@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../events/entitycollision.hpp"
+#include "../scheduler.hpp"
 #include <fmtlog/fmtlog.hpp>
 #include <entityx/entityx.h>
 
@@ -15,6 +16,9 @@ struct Projectiles : public entityx::System<Projectiles>, public entityx::Receiv
 
   void configure(entityx::EventManager& events) override;
 
+  /// Declares the data accessed by the system, see SystemScheduler.
+  static SystemAccess access();
+
   void update(entityx::EntityManager& es, entityx::EventManager& events, entityx::TimeDelta dt) override;
 
   void receive(const events::EntityCollision& event);
@@ -35,8 +39,10 @@ private:
    *
    *  \param events the event manager
    *  \param projectileEntity the projectile being triggered
+   *  \param timeOfImpact the fraction of the last step at which the projectile was triggered
    */
-  void triggerProjectile(entityx::EventManager& events, entityx::Entity projectileEntity);
+  void triggerProjectile(entityx::EventManager& events, entityx::Entity projectileEntity,
+                         float timeOfImpact);
 
 private:
   fmtlog::Log log = fmtlog::For<Projectiles>();
@@ -6,23 +6,46 @@
 
 using namespace octo::game;
 
-World::World() {
-  // configure entity component system (order is important)
-  systems.add<systems::Attraction>();
-  systems.add<systems::Collision>(*this);
+World::World(bool debugData) {
+  // configure entity component system (order is important for conflicting systems)
+  m_attraction = addSystem<systems::Attraction>("Attraction");
+  addSystem<systems::Collision>("Collision", *this);
   // it's important that bouncing happens immediately after collision detection:
-  systems.add<systems::Bounce>();
-  systems.add<systems::Projectiles>();
-  systems.add<systems::Explosions>();
-  systems.add<systems::HealthSystem>();
-  systems.add<systems::Physics>(*this);
-  systems.add<systems::BoundaryEnforcer>(0);
-  systems.add<systems::Debug>();
+  addSystem<systems::Bounce>("Bounce");
+  addSystem<systems::Projectiles>("Projectiles");
+  addSystem<systems::BoundingVolumes>("BoundingVolumes", *this);
+  addSystem<systems::Explosions>("Explosions", *this);
+  addSystem<systems::Fragmentation>("Fragmentation");
+  addSystem<systems::Particles>("Particles", *this, *m_attraction);
+  addSystem<systems::HealthSystem>("HealthSystem");
+  addSystem<systems::Physics>("Physics", *this);
+  addSystem<systems::BoundaryEnforcer>("BoundaryEnforcer", 0);
+  if (debugData) {
+    addSystem<systems::Debug>("Debug");
+  }
+  // ordering constraints that must hold regardless of the declared accesses
+  m_scheduler.addDependency<systems::Bounce, systems::Collision>();
+  m_scheduler.addDependency<systems::Explosions, systems::BoundingVolumes>();
+  m_scheduler.addDependency<systems::Fragmentation, systems::Explosions>();
+  m_scheduler.addDependency<systems::Particles, systems::Attraction>();
+  m_scheduler.addDependency<systems::Physics, systems::Attraction>();
+  m_scheduler.addDependency<systems::Physics, systems::Bounce>();
+  m_scheduler.addDependency<systems::BoundaryEnforcer, systems::Physics>();
   systems.configure();
 
   setClipRadius(1000); // depends on m_boundaryEnforcer
 }
 
+template <class S, typename... Args>
+std::shared_ptr<S> World::addSystem(const char* name, Args&&... args) {
+  auto system = systems.add<S>(std::forward<Args>(args)...);
+  // the timing index equals the index in the scheduler
+  m_scheduler.add(
+      typeid(S), [this](entityx::TimeDelta dt) { systems.update<S>(dt); }, S::access());
+  m_statistics.addTiming(name);
+  return system;
+}
+
 entityx::Entity World::addPlanet(sf::Vector2f position, int radius, float mass) {
   entityx::Entity planet = entities.create();
 
@@ -33,7 +56,10 @@ entityx::Entity World::addPlanet(sf::Vector2f position, int radius, float mass)
 
   planet.assign<components::Planet>();
 
-  planet.assign<components::CollisionMask>(collision::circle(radius, collision::Pixel::SolidDestructible));
+  auto mask = planet.assign<components::CollisionMask>(
+      collision::circle(radius, collision::Pixel::SolidDestructible));
+  // planets are large and hit frequently, normals are cheaper to derive from a distance field
+  mask->enableDistanceField();
   planet.assign<components::Material>(0.7f, 0.2f);
   return planet;
 }
@@ -47,8 +73,10 @@ entityx::Entity World::spawnDebugBullet(sf::Vector2f position, sf::Vector2f velo
   body->setInertia(100);
   body->setVelocity(velocity);
   bullet.assign<components::Attractable>(1, components::Attractable::PlanetBit);
-  bullet.assign<components::CollisionMask>(collision::circle(4, collision::Pixel::SolidIndestructible));
-  bullet.assign_from_copy(components::Projectile { 50 });
+  bullet.assign<components::CollisionMask>(m_shapes.circle(4, collision::Pixel::SolidIndestructible));
+  // the small mask only matters against other projectiles, everything else tests the bullet's path
+  bullet.assign_from_copy(
+      components::Projectile { 50, 0, components::Projectile::Hitbox::Segment });
   bullet.assign<components::Material>(0.8f, 0.1f);
   return bullet;
 }
@@ -62,17 +90,58 @@ entityx::Entity World::spawnVessel(sf::Vector2f position, float rotation) {
   body->setMass(1);
   body->setInertia(1000);
   vessel.assign<components::Attractable>(1, components::Attractable::PlanetBit);
-  vessel.assign<components::CollisionMask>(collision::ellipse(32, 24, collision::Pixel::SolidIndestructible));
+  vessel.assign<components::CollisionMask>(m_shapes.ellipse(32, 24, collision::Pixel::SolidIndestructible));
   vessel.assign_from_copy(components::Vessel { });
   vessel.assign<components::Material>(0.7f, 0.2f);
   return vessel;
 }
 
 void World::update(float timeStep) {
-  systems.update_all(timeStep);
+  m_scheduler.run(timeStep, m_statistics);
+  m_statistics.finishStep();
   m_updateCount += 1;
 }
 
+size_t World::systemThreads() const {
+  return m_scheduler.threadCount();
+}
+
+void World::setSystemThreads(size_t threads) {
+  m_scheduler.setThreadCount(threads);
+}
+
+size_t World::updateCount() const {
+  return m_updateCount;
+}
+
+Statistics& World::statistics() {
+  return m_statistics;
+}
+
+const Statistics& World::statistics() const {
+  return m_statistics;
+}
+
+collision::AabbTree& World::aabbTree() {
+  return m_aabbTree;
+}
+
+const collision::AabbTree& World::aabbTree() const {
+  return m_aabbTree;
+}
+
+collision::ShapeCache& World::shapes() {
+  return m_shapes;
+}
+
+ParticlePool& World::particles() {
+  return m_particles;
+}
+
+const ParticlePool& World::particles() const {
+  return m_particles;
+}
+
 float World::clipRadius() const {
   return m_clipRadius;
 }
@@ -80,12 +149,37 @@ float World::clipRadius() const {
 void World::setClipRadius(float radius) {
   m_clipRadius = radius;
   systems.system<systems::BoundaryEnforcer>()->setBoundaryRadius(radius);
+  m_attraction->setFieldRadius(radius);
 }
 
-void World::interpolateState(float alpha) {
-  using namespace components;
+systems::Attraction::Mode World::attractionMode() const {
+  return m_attraction->mode();
+}
+
+void World::setAttractionMode(systems::Attraction::Mode mode) {
+  m_attraction->setMode(mode);
+}
+
+float World::attractionOpeningAngle() const {
+  return m_attraction->openingAngle();
+}
+
+void World::setAttractionOpeningAngle(float openingAngle) {
+  m_attraction->setOpeningAngle(openingAngle);
+}
+
+bool World::staticAttractionField() const {
+  return m_attraction->staticFieldEnabled();
+}
+
+void World::setStaticAttractionField(bool enabled) {
+  m_attraction->setStaticFieldEnabled(enabled);
+}
+
+size_t World::attractionThreads() const {
+  return m_attraction->threadCount();
+}
 
-  entities.each<Spatial>([alpha](entityx::Entity, Spatial& spatial) {
-    spatial.interpolate(alpha);
-  });
+void World::setAttractionThreads(size_t threads) {
+  m_attraction->setThreadCount(threads);
 }
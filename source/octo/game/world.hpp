@@ -1,6 +1,12 @@
 #pragma once
 
+#include "collision/aabbtree.hpp"
+#include "collision/shape.hpp"
+#include "particlepool.hpp"
+#include "systems/attractionsystem.hpp"
 #include "systems/boundaryenforcer.hpp"
+#include "scheduler.hpp"
+#include "statistics.hpp"
 
 #include <entityx/entityx.h>
 #include <SFML/System/Time.hpp>
@@ -14,7 +20,13 @@ namespace game {
 
 class World : public entityx::EntityX {
 public:
-  World();
+  /*! \brief Initializes the world and its systems.
+   *
+   *  \param debugData whether to maintain \ref components::DebugData for every entity.
+   *  The debug data contains textures, which require a graphics context, hence it must be
+   *  disabled when running without a window.
+   */
+  explicit World(bool debugData = true);
 
   entityx::Entity addPlanet(sf::Vector2f position, int radius, float mass);
 
@@ -22,8 +34,56 @@ public:
 
   entityx::Entity spawnVessel(sf::Vector2f position, float rotation);
 
+  /*! \brief Advances the simulation by one step.
+   *
+   *  The systems are run by a SystemScheduler, in parallel where their declared accesses
+   *  allow it, recording the time spent in each of them in \ref statistics.
+   *  \param timeStep the time step in seconds.
+   */
   void update(float timeStep);
 
+  /// the number of worker threads running systems in parallel
+  size_t systemThreads() const;
+
+  /*! \brief Sets the number of worker threads running systems in parallel.
+   *
+   *  With zero threads, all systems run on the thread calling \ref update.
+   */
+  void setSystemThreads(size_t threads);
+
+  /// The number of completed calls to \ref update.
+  size_t updateCount() const;
+
+  /*! \brief Timings of the systems and counters of the work done per step.
+   *
+   *  Systems record their counters here during \ref update.
+   */
+  Statistics& statistics();
+
+  /// \copydoc statistics()
+  const Statistics& statistics() const;
+
+  /*! \brief The bounding boxes of all entities with a collision mask.
+   *
+   *  The tree is maintained by systems::BoundingVolumes and reflects the positions
+   *  at the beginning of the current step.
+   */
+  collision::AabbTree& aabbTree();
+
+  /// \copydoc aabbTree()
+  const collision::AabbTree& aabbTree() const;
+
+  /*! \brief The shapes shared by the collision masks of spawned entities.
+   */
+  collision::ShapeCache& shapes();
+
+  /*! \brief The debris particles, simulated by systems::Particles.
+   */
+  ParticlePool& particles();
+
+  /// \copydoc particles()
+  const ParticlePool& particles() const;
+
   // accessors
 
   /**
@@ -39,20 +99,69 @@ public:
    */
   void setClipRadius(float radius);
 
-  /*! \brief Interpolates the world state between the current and last update.
+  /// The strategy used for computing attractive forces.
+  systems::Attraction::Mode attractionMode() const;
+
+  /*! \brief Sets the strategy used for computing attractive forces.
+   *  \param mode the new strategy
+   */
+  void setAttractionMode(systems::Attraction::Mode mode);
+
+  /*! \brief The opening angle of the Barnes-Hut approximation of attractive forces.
+   *  \see systems::Attraction::openingAngle
+   */
+  float attractionOpeningAngle() const;
+
+  /*! \brief Sets the opening angle of the Barnes-Hut approximation of attractive forces.
    *
-   *  The following entity types are affected:
-   *    - the interpolated position of dynamic bodies is stored in
-   *      their \ref components::Spatial "Spatial" component.
+   *  Only has an effect when the attraction mode is systems::Attraction::Mode::BarnesHut.
+   *  \param openingAngle the new opening angle, zero disables the approximation.
+   */
+  void setAttractionOpeningAngle(float openingAngle);
+
+  /*! \brief Whether the forces of static attractors (i.e. planets) are precomputed.
+   *  \see systems::Attraction::staticFieldEnabled
+   */
+  bool staticAttractionField() const;
+
+  /*! \brief Enables or disables precomputing the forces of static attractors.
+   *
+   *  The precomputed field covers the area within the \ref clipRadius.
+   *  \param enabled \c true for sampling the forces from a precomputed grid.
+   */
+  void setStaticAttractionField(bool enabled);
+
+  /*! \brief The number of worker threads used for computing attractive forces.
+   *  \see systems::Attraction::threadCount
+   */
+  size_t attractionThreads() const;
+
+  /*! \brief Sets the number of worker threads used for computing attractive forces.
+   *  \param threads the number of worker threads, zero computes all forces on the calling thread.
+   */
+  void setAttractionThreads(size_t threads);
+
+private:
+  /*! \brief Registers a system with the scheduler.
    *
-   *  \param alpha the interpolation function
+   *  Conflicting systems are updated in the order of registration.
+   *  \param name the name of the system used in the \ref statistics.
+   *  \param args the constructor arguments of the system.
    */
-  void interpolateState(float alpha);
+  template <class S, typename... Args>
+  std::shared_ptr<S> addSystem(const char* name, Args&&... args);
 
 private:
   float m_clipRadius;
   float m_gravitationalConstant = 100.f;
   size_t m_updateCount = 0;
+  std::shared_ptr<systems::Attraction> m_attraction;
+  SystemScheduler m_scheduler;
+  Statistics m_statistics;
+  collision::AabbTree m_aabbTree;
+  collision::ShapeCache m_shapes;
+  /// the storage for particles is allocated once, for this many
+  ParticlePool m_particles{1 << 16};
 };
 
 }
@@ -3,6 +3,7 @@
 #include <SFML/Graphics/Rect.hpp>
 #include <SFML/System/Vector2.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 namespace octo {
@@ -43,6 +44,27 @@ sf::Rect<T> rect_cast(const sf::Rect<U>& rect) {
   return {topLeft, bottomRight - topLeft};
 }
 
+/*! \brief Computes the smallest rectangle containing two rectangles.
+ *
+ *  Rectangles without area are ignored, so an empty rectangle can be used as the initial value
+ *  when merging a sequence of rectangles.
+ *  \returns the bounding rectangle of \p a and \p b.
+ */
+template <typename T>
+sf::Rect<T> merge(const sf::Rect<T>& a, const sf::Rect<T>& b) {
+  if (a.width <= 0 || a.height <= 0) {
+    return b;
+  }
+  if (b.width <= 0 || b.height <= 0) {
+    return a;
+  }
+  T left = std::min(a.left, b.left);
+  T top = std::min(a.top, b.top);
+  T right = std::max(a.left + a.width, b.left + b.width);
+  T bottom = std::max(a.top + a.height, b.top + b.height);
+  return {left, top, right - left, bottom - top};
+}
+
 }
 }
 }
@@ -7,6 +7,7 @@
 #include <octo/game/collision/mask.hpp>
 #include <octo/game/collision/util.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -18,49 +19,101 @@ using namespace octo::game::components;
 
 InGameState::InGameState() {
   // TODO: take world as an argument
-  m_world = std::make_unique<game::World>();
-  m_world->setClipRadius(900);
+  auto world = std::make_unique<game::World>();
+  world->setClipRadius(900);
 
-  m_world->addPlanet({300, 200}, 128, 30000);
-  m_world->addPlanet({-150, -200}, 128, 30000);
-  m_world->addPlanet({150, -200}, 22, 3000);
+  world->addPlanet({300, 200}, 128, 30000);
+  world->addPlanet({-150, -200}, 128, 30000);
+  world->addPlanet({150, -200}, 22, 3000);
 
   for(float angle = 0; angle < 360; angle += 36) {
     float rad = angle / 180.f * boost::math::constants::pi<float>();
     sf::Vector2f dir { std::cos(rad), std::sin(rad) };
-    m_world->spawnDebugBullet(sf::Vector2f {-320, -320} + dir * 15.f, dir * 120.f);
+    world->spawnDebugBullet(sf::Vector2f {-320, -320} + dir * 15.f, dir * 120.f);
   }
-  m_paused = true;
 
-  m_world->spawnVessel({450, 250}, 180);
-  //auto b = m_world->spawnDebugBullet({300, 60}, {0, 0});
+  world->spawnVessel({450, 250}, 180);
+  //auto b = world->spawnDebugBullet({300, 60}, {0, 0});
 
-  // m_world->addPlanet({0, 0}, 128, 30000);
-  // m_world->spawnDebugBullet({0,-400}, {0, 0});
+  // world->addPlanet({0, 0}, 128, 30000);
+  // world->spawnDebugBullet({0,-400}, {0, 0});
+
+  // the simulation starts paused
+  m_simulation = std::make_unique<game::Simulation>(std::move(world), m_physicsStep);
+  m_snapshot = m_simulation->latest();
 }
 
 void InGameState::update(sf::Time elapsed) {
-  if(m_paused) {
-    return;
+  // the simulation advances on its own thread, only pick up its latest state
+  std::shared_ptr<const game::WorldSnapshot> latest = m_simulation->latest();
+  if (latest != m_snapshot) {
+    // the previous snapshot is no longer read, the simulation may capture into it
+    m_simulation->release(std::move(m_snapshot));
+    m_snapshot = std::move(latest);
   }
-  // fill time accumulator
-  double elapsedSeconds = elapsed.asSeconds();
-  if (elapsedSeconds > 0.125) {
-    // cap frame rate at 8 FPS to prevent spiral of death.
-    // note that this will cause the simulation to run slower
-    elapsedSeconds = 0.125f;
+  m_alpha = m_simulation->interpolationAlpha(*m_snapshot);
+  game()->debugOverlay().setStatistics(&m_snapshot->statistics);
+  updateMaskTextures();
+  updateParticleVertices();
+}
+
+void InGameState::updateParticleVertices() {
+  const auto& particles = m_snapshot->particles;
+  // resizing keeps the storage, so this only allocates when the number of particles peaks
+  m_particleVertices.resize(particles.size());
+  for (size_t i = 0; i < particles.size(); ++i) {
+    m_particleVertices[i].position = particles[i];
+    m_particleVertices[i].color = sf::Color(160, 140, 110);
   }
-  m_timeAccumulator += elapsedSeconds * m_timeFactor;
+}
 
-  // perform fixed time steps on accumulated time
-  while (m_timeAccumulator >= m_physicsStep) {
-    m_world->update(m_physicsStep);
-    m_timeAccumulator -= m_physicsStep;
+void InGameState::updateMaskTextures() {
+  for (auto& entry : m_maskTextures) {
+    entry.second.used = false;
   }
+  for (const auto& entity : m_snapshot->entities) {
+    if (entity.maskImage) {
+      MaskTexture& cached = m_maskTextures[entity.id];
+      cached.used = true;
+      // images are replaced when the mask changes, so identity implies equal contents
+      if (cached.image != entity.maskImage) {
+        const sf::Image& image = entity.maskImage->image;
+        sf::Rect<unsigned> changed;
+        if (cached.image && cached.image->image.getSize() == image.getSize() &&
+            entity.maskImage->changedSince(cached.image->revision, changed)) {
+          uploadRegion(cached.texture, image, changed);
+        } else {
+          cached.texture.loadFromImage(image);
+        }
+        cached.image = entity.maskImage;
+      }
+    }
+  }
+  for (auto it = m_maskTextures.begin(); it != m_maskTextures.end();) {
+    if (it->second.used) {
+      ++it;
+    } else {
+      it = m_maskTextures.erase(it);
+    }
+  }
+}
 
-  // interpolation
-  const double alpha = m_timeAccumulator / m_physicsStep;
-  m_world->interpolateState(alpha);
+void InGameState::uploadRegion(sf::Texture& texture, const sf::Image& image,
+                               const sf::Rect<unsigned>& region) {
+  if (region.width == 0 || region.height == 0) {
+    return;
+  }
+  // the texture expects the pixels of the region without the gaps between rows of the image
+  const size_t bytesPerPixel = 4;
+  const size_t rowBytes = region.width * bytesPerPixel;
+  const sf::Uint8* pixels = image.getPixelsPtr();
+  m_uploadBuffer.resize(rowBytes * region.height);
+  for (unsigned y = 0; y < region.height; ++y) {
+    const sf::Uint8* row =
+        pixels + ((region.top + y) * image.getSize().x + region.left) * bytesPerPixel;
+    std::copy(row, row + rowBytes, m_uploadBuffer.begin() + y * rowBytes);
+  }
+  texture.update(m_uploadBuffer.data(), region.width, region.height, region.left, region.top);
 }
 
 void InGameState::handleEvents() {
@@ -75,10 +128,10 @@ void InGameState::handleEvents() {
     case sf::Event::KeyPressed:
       switch (event.key.code) {
       case sf::Keyboard::Space:
-        m_paused = !m_paused;
+        m_simulation->setPaused(!m_simulation->paused());
         break;
       case sf::Keyboard::LShift:
-        m_timeFactor = 0.4f;
+        m_simulation->setTimeFactor(0.4f);
         log.debug("bullet time activated");
         break;
       default:
@@ -88,7 +141,7 @@ void InGameState::handleEvents() {
     case sf::Event::KeyReleased:
       switch (event.key.code) {
       case sf::Keyboard::LShift:
-        m_timeFactor = 1.0f;
+        m_simulation->setTimeFactor(1.0f);
         log.debug("bullet time deactivated");
         break;
       default:
@@ -101,13 +154,20 @@ void InGameState::handleEvents() {
   }
 }
 
-void InGameState::activated() {}
+void InGameState::activated() {
+  game()->debugOverlay().setStatistics(&m_snapshot->statistics);
+}
+
+void InGameState::deactivated() {
+  game()->debugOverlay().setStatistics(nullptr);
+}
 
 void InGameState::draw(sf::RenderTarget& target) {
   applyView(target);
   target.clear(sf::Color::Black);
   drawBackground(target);
   drawPlanets(target);
+  drawParticles(target);
   debugDraw(target);
 }
 
@@ -117,25 +177,30 @@ void InGameState::drawBackground(sf::RenderTarget& target) const {
 }
 
 void InGameState::drawPlanets(sf::RenderTarget& target) const {
-  m_world->entities.each<Spatial, Planet>([&](entityx::Entity, Spatial& spatial, Planet& planet) {
-    const SpatialSnapshot& interpolated = spatial.interpolated();
-    // TODO: draw planet textures
-  });
+  for (const auto& entity : m_snapshot->entities) {
+    if (entity.planet) {
+      const SpatialSnapshot interpolated = entity.interpolated(m_alpha);
+      // TODO: draw planet textures
+    }
+  }
+}
+
+void InGameState::drawParticles(sf::RenderTarget& target) const {
+  // all particles are drawn at once
+  target.draw(m_particleVertices);
 }
 
 void InGameState::debugDraw(sf::RenderTarget& target) const {
   using rendering::DebugDraw;
-  DebugDraw::circle(sf::Vector2f(), m_world->clipRadius()).outline(2, sf::Color::Red).draw(target);
-  m_world->entities.each<Spatial>([&](entityx::Entity e, Spatial& spatial) {
-    const SpatialSnapshot& interpolated = spatial.interpolated();
-    auto debugData = e.component<DebugData>();
-    auto coll = e.component<CollisionMask>();
-    auto body = e.component<DynamicBody>();
+  DebugDraw::circle(sf::Vector2f(), m_snapshot->clipRadius).outline(2, sf::Color::Red).draw(target);
+  for (const auto& entity : m_snapshot->entities) {
+    const SpatialSnapshot interpolated = entity.interpolated(m_alpha);
     // show collision mask
-    if (debugData && coll) {
-      const sf::Texture& tex = debugData->collisionMaskTexture;
+    auto texture = m_maskTextures.find(entity.id);
+    if (texture != m_maskTextures.end()) {
+      const sf::Texture& tex = texture->second.texture;
       sf::Sprite sprite(tex);
-      sprite.setOrigin(math::vector::vector_cast<float>(tex.getSize()) * 0.5f - coll->anchor);
+      sprite.setOrigin(math::vector::vector_cast<float>(tex.getSize()) * 0.5f - entity.maskAnchor);
       sprite.setRotation(interpolated.rotationDegrees);
       sprite.setPosition(interpolated.position);
       target.draw(sprite);
@@ -145,8 +210,8 @@ void InGameState::debugDraw(sf::RenderTarget& target) const {
         .fill(sf::Color::Red)
         .draw(target);
     // show velocity
-    if (body) {
-      auto vel = body->velocity();
+    if (entity.hasBody) {
+      auto vel = entity.velocity;
       float mag = math::vector::length(vel);
       DebugDraw::rectangle(interpolated.position,
                            {0, 0.5},
@@ -155,7 +220,7 @@ void InGameState::debugDraw(sf::RenderTarget& target) const {
           .fill(sf::Color::Green)
           .draw(target);
     }
-  });
+  }
 }
 
 void InGameState::applyView(sf::RenderTarget& target) const {
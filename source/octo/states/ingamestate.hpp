@@ -1,10 +1,15 @@
 #pragma once
 
-#include "../game/world.hpp"
+#include "../game/simulation.hpp"
+#include "../game/snapshot.hpp"
 #include "../gamestate.hpp"
 #include <fmtlog/fmtlog.hpp>
 
+#include <map>
 #include <memory>
+#include <vector>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/Graphics/View.hpp>
 
 namespace octo {
@@ -21,25 +26,49 @@ protected:
   void draw(sf::RenderTarget& target) override;
   void drawBackground(sf::RenderTarget& target) const;
   void drawPlanets(sf::RenderTarget& target) const;
+  void drawParticles(sf::RenderTarget& target) const;
   void debugDraw(sf::RenderTarget& target) const;
 
+  /// Synchronizes the collision mask textures with the images of the current snapshot.
+  void updateMaskTextures();
+
+  /// Rebuilds the vertices of the particles of the current snapshot.
+  void updateParticleVertices();
+
+  /// Uploads a region of \p image to the same region of \p texture.
+  void uploadRegion(sf::Texture& texture, const sf::Image& image, const sf::Rect<unsigned>& region);
+
   void activated() override;
+  void deactivated() override;
 
   void applyView(sf::RenderTarget& target) const;
 
 private:
   fmtlog::Log log = fmtlog::For<InGameState>();
-  std::unique_ptr<game::World> m_world;
+  /// runs the world on its own thread
+  std::unique_ptr<game::Simulation> m_simulation;
+  /// the snapshot currently being rendered
+  std::shared_ptr<const game::WorldSnapshot> m_snapshot;
+  /// the blend factor between the previous and current step of \ref m_snapshot
+  float m_alpha = 1;
+
+  /// A collision mask texture, uploaded from a snapshot image.
+  struct MaskTexture {
+    std::shared_ptr<const game::components::MaskImage> image;
+    sf::Texture texture;
+    /// whether the entity was part of the current snapshot
+    bool used = false;
+  };
+  std::map<entityx::Entity::Id, MaskTexture> m_maskTextures;
+  /// the pixels of a changed region, reused for uploading them
+  std::vector<sf::Uint8> m_uploadBuffer;
+  /// one point per particle of the current snapshot
+  sf::VertexArray m_particleVertices{sf::Points};
 
   sf::Vector2f m_viewCenter;
   float m_viewZoom = 1.5f;
 
   float m_physicsStep = 1.f / 100.f;
-  float m_timeFactor = 1.f;
-  float m_timeAccumulator = 0;
-  int m_maxStepsPerFrame = 10;
-
-  bool m_paused = false;
 };
 
 }
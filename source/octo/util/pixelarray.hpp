@@ -50,6 +50,19 @@ public:
     swap(other, *this);
   }
 
+  /*! \brief Creates a copy of the pixels.
+   *
+   *  Pixel arrays are only copied explicitly, since they tend to be large.
+   *  \returns a new array with the same size and pixels.
+   */
+  PixelArray clone() const {
+    PixelArray result(0, 0);
+    result.m_pixels = m_pixels;
+    result.m_width = m_width;
+    result.m_height = m_height;
+    return result;
+  }
+
   size_t index(size_t x, size_t y) const {
     assert(x >= 0 && x < m_width);
     assert(y >= 0 && y < m_height);
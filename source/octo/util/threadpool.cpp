@@ -0,0 +1,71 @@
+#include "threadpool.hpp"
+
+namespace octo {
+namespace util {
+
+ThreadPool::ThreadPool(size_t threads) {
+  for (size_t i = 0; i < threads; ++i) {
+    m_workers.emplace_back([this]() { work(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_taskAvailable.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::size() const {
+  return m_workers.size();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  if (m_workers.empty()) {
+    // nobody would ever pick up the task
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push(std::move(task));
+    m_pending += 1;
+  }
+  m_taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_tasksFinished.wait(lock, [this]() { return m_pending == 0; });
+}
+
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_taskAvailable.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+      if (m_tasks.empty()) {
+        // only reached when stopping
+        return;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+    task();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pending -= 1;
+      if (m_pending == 0) {
+        m_tasksFinished.notify_all();
+      }
+    }
+  }
+}
+
+}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace octo {
+namespace util {
+
+/*! \brief A fixed set of worker threads executing submitted tasks.
+ */
+class ThreadPool {
+public:
+  /*! \brief Starts the worker threads.
+   *  \param threads the number of worker threads.
+   */
+  explicit ThreadPool(size_t threads);
+
+  /*! \brief Finishes all pending tasks and joins the worker threads.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// the number of worker threads
+  size_t size() const;
+
+  /*! \brief Schedules a task for execution on one of the worker threads.
+   *
+   *  A pool without worker threads executes the task immediately.
+   *  \param task the task to be executed.
+   */
+  void submit(std::function<void()> task);
+
+  /*! \brief Blocks until all submitted tasks have been completed.
+   */
+  void wait();
+
+  /*! \brief Splits the range \c [0, count) into chunks and processes them in parallel.
+   *
+   *  The function blocks until all chunks have been processed. The chunks only depend on
+   *  \p count and \p chunkSize, not on the number of threads.
+   *
+   *  \param count the size of the range.
+   *  \param chunkSize the maximum number of elements per chunk.
+   *  \param fn a function called as \c fn(begin, end) for every chunk.
+   */
+  template <typename F>
+  void parallelFor(size_t count, size_t chunkSize, F fn) {
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+      size_t end = std::min(count, begin + chunkSize);
+      submit([fn, begin, end]() { fn(begin, end); });
+    }
+    wait();
+  }
+
+private:
+  /// The main loop of the worker threads.
+  void work();
+
+  std::vector<std::thread> m_workers;
+  std::queue<std::function<void()>> m_tasks;
+  /// the number of tasks that have been submitted, but are not finished yet
+  size_t m_pending = 0;
+  bool m_stopping = false;
+  std::mutex m_mutex;
+  /// signalled when a new task is available or the pool is stopping
+  std::condition_variable m_taskAvailable;
+  /// signalled when all pending tasks are finished
+  std::condition_variable m_tasksFinished;
+};
+
+}
+}
@@ -0,0 +1,163 @@
+#include "octo/game/scenario.hpp"
+#include "octo/game/systems.hpp"
+#include "octo/game/world.hpp"
+#include "fmtlog/fmtlog.hpp"
+
+#include <boost/format.hpp>
+#include <boost/type_index.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace octo::game;
+
+namespace {
+
+/// Parameters of a headless simulation run.
+struct Options {
+  Scenario scenario;
+  /// the number of simulation steps
+  size_t steps = 1000;
+  /// the duration of a single step in seconds
+  float timeStep = 1 / 60.f;
+  systems::Attraction::Mode attraction = systems::Attraction::Mode::Vectorized;
+  systems::Collision::Broadphase broadphase = systems::Collision::Broadphase::SpatialHash;
+  /// the number of worker threads of the attraction system
+  size_t threads = 0;
+  /// the number of worker threads running systems in parallel
+  size_t systemThreads = 0;
+  /// if not empty, log messages are written to this binary log
+  std::string binaryLog;
+};
+
+void printUsage() {
+  std::cout <<
+    "usage: gravity-sim [options]\n"
+    "  --planets N        number of planets (default 3)\n"
+    "  --bullets N        number of bullets (default 100)\n"
+    "  --vessels N        number of vessels (default 1)\n"
+    "  --seed N           seed for placing the entities (default 0)\n"
+    "  --radius R         radius of the populated region (default 800)\n"
+    "  --steps N          number of simulation steps (default 1000)\n"
+    "  --step S           duration of a step in seconds (default 1/60)\n"
+    "  --attraction M     pairwise, vectorized or barneshut (default vectorized)\n"
+    "  --broadphase M     bruteforce, spatialhash or sweepandprune (default spatialhash)\n"
+    "  --threads N        attraction worker threads (default 0)\n"
+    "  --system-threads N threads running systems in parallel (default 0)\n"
+    "  --binary-log PATH  write log messages to a binary log (see fmtlog-decode)\n";
+}
+
+Options parseOptions(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      printUsage();
+      std::exit(0);
+    }
+    if (i + 1 >= argc) {
+      throw std::invalid_argument("missing value for " + arg);
+    }
+    std::string value = argv[++i];
+    if (arg == "--planets") {
+      options.scenario.planets = std::stoul(value);
+    } else if (arg == "--bullets") {
+      options.scenario.bullets = std::stoul(value);
+    } else if (arg == "--vessels") {
+      options.scenario.vessels = std::stoul(value);
+    } else if (arg == "--seed") {
+      options.scenario.seed = static_cast<uint32_t>(std::stoul(value));
+    } else if (arg == "--radius") {
+      options.scenario.radius = std::stof(value);
+    } else if (arg == "--steps") {
+      options.steps = std::stoul(value);
+    } else if (arg == "--step") {
+      options.timeStep = std::stof(value);
+    } else if (arg == "--attraction") {
+      if (value == "pairwise") {
+        options.attraction = systems::Attraction::Mode::Pairwise;
+      } else if (value == "vectorized") {
+        options.attraction = systems::Attraction::Mode::Vectorized;
+      } else if (value == "barneshut") {
+        options.attraction = systems::Attraction::Mode::BarnesHut;
+      } else {
+        throw std::invalid_argument("unknown attraction mode " + value);
+      }
+    } else if (arg == "--broadphase") {
+      if (value == "bruteforce") {
+        options.broadphase = systems::Collision::Broadphase::BruteForce;
+      } else if (value == "spatialhash") {
+        options.broadphase = systems::Collision::Broadphase::SpatialHash;
+      } else if (value == "sweepandprune") {
+        options.broadphase = systems::Collision::Broadphase::SweepAndPrune;
+      } else {
+        throw std::invalid_argument("unknown broadphase " + value);
+      }
+    } else if (arg == "--threads") {
+      options.threads = std::stoul(value);
+    } else if (arg == "--system-threads") {
+      options.systemThreads = std::stoul(value);
+    } else if (arg == "--binary-log") {
+      options.binaryLog = value;
+    } else {
+      throw std::invalid_argument("unknown option " + arg);
+    }
+  }
+  return options;
+}
+
+void run(const Options& options) {
+  if (!options.binaryLog.empty()) {
+    fmtlog::enableBinary(options.binaryLog);
+  }
+  World world(false);
+  world.setClipRadius(options.scenario.radius * 1.5f);
+  world.setAttractionMode(options.attraction);
+  world.setAttractionThreads(options.threads);
+  world.setSystemThreads(options.systemThreads);
+  world.systems.system<systems::Collision>()->setBroadphase(options.broadphase);
+  populate(world, options.scenario);
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < options.steps; ++i) {
+    world.update(options.timeStep);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << boost::format("%d steps in %.3f s (%.1f steps/s), %d entities remaining\n")
+    % options.steps % elapsed.count() % (options.steps / elapsed.count()) % world.entities.size();
+  const Statistics& statistics = world.statistics();
+  for (const auto& timing : statistics.timings()) {
+    const RollingSeries& seconds = timing.seconds;
+    double average = seconds.samples() > 0 ? seconds.total() / seconds.samples() : 0;
+    std::cout << boost::format("  %-18s %10.3f ms/step %6.1f %%  (last %d steps: max %.3f ms)\n")
+      % timing.name % (average * 1000) % (100 * seconds.total() / elapsed.count())
+      % std::min(seconds.samples(), statistics.window()) % (seconds.max() * 1000);
+  }
+  for (size_t i = 0; i < Statistics::CounterCount; ++i) {
+    auto counter = static_cast<Statistics::Counter>(i);
+    const RollingSeries& series = statistics.counter(counter);
+    double average = series.samples() > 0 ? series.total() / series.samples() : 0;
+    std::cout << boost::format("  %-18s %10.1f per step (total %.0f)\n")
+      % Statistics::counterName(counter) % average % series.total();
+  }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+  // measurements should not include waiting for stderr
+  fmtlog::enableAsync();
+  fmtlog::Log log("<sim>");
+  try {
+    run(parseOptions(argc, argv));
+  } catch(const std::exception& ex) {
+    log.fatal("unhandled exception of type %s: %s", boost::typeindex::type_id_runtime(ex).pretty_name(), ex.what());
+    return 1;
+  }
+  return 0;
+}